@@ -0,0 +1,141 @@
+/* SPDX-License-Identifier: BSD-3-Clause */
+
+/*
+ * Copyright (c) 2026 Jeffrey H. Johnson
+ *
+ * See the LICENSE.md file for redistribution information.
+ */
+
+/*
+ * balloc -- count a program's allocations
+ *
+ * Loaded with LD_PRELOAD, this counts the calls to malloc, calloc and
+ * realloc, and writes the count to the file named by BENCH_ALLOCS when
+ * the program exits.
+ */
+
+#ifndef _GNU_SOURCE
+# define _GNU_SOURCE
+#endif /* ifndef _GNU_SOURCE */
+
+#include <sys/types.h>
+
+#include <dlfcn.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static void *(*b_malloc)(size_t);
+static void *(*b_calloc)(size_t, size_t);
+static void *(*b_realloc)(void *, size_t);
+static void (*b_free)(void *);
+
+static unsigned long nallocs;
+
+/*
+ * dlsym may allocate before the real functions are known; give it memory
+ * from here, which is never freed.
+ */
+static char boot[4096];
+static size_t bootlen;
+static int booting;
+
+#define INBOOT(p)                                                       \
+        ((char *)(p) >= boot && (char *)(p) < boot + sizeof(boot))
+
+static void
+b_init(void)
+{
+        booting = 1;
+        b_malloc = (void *(*)(size_t))dlsym(RTLD_NEXT, "malloc");
+        b_calloc = (void *(*)(size_t, size_t))dlsym(RTLD_NEXT, "calloc");
+        b_realloc = (void *(*)(void *, size_t))dlsym(RTLD_NEXT, "realloc");
+        b_free = (void (*)(void *))dlsym(RTLD_NEXT, "free");
+        booting = 0;
+        if (b_malloc == NULL || b_calloc == NULL ||
+            b_realloc == NULL || b_free == NULL)
+                abort();
+}
+
+static void *
+b_boot(size_t len)
+{
+        void *p;
+
+        len = (len + 15) & ~(size_t)15;
+        if (len > sizeof(boot) - bootlen)
+                return (NULL);
+        p = boot + bootlen;
+        bootlen += len;
+        return (p);
+}
+
+void *
+malloc(size_t len)
+{
+        if (b_malloc == NULL) {
+                if (booting)
+                        return (b_boot(len));
+                b_init();
+        }
+        ++nallocs;
+        return (b_malloc(len));
+}
+
+void *
+calloc(size_t n, size_t size)
+{
+        if (b_calloc == NULL) {
+                if (booting)
+                        return (size != 0 && n > (size_t)-1 / size ?
+                            NULL : b_boot(n * size));
+                b_init();
+        }
+        ++nallocs;
+        return (b_calloc(n, size));
+}
+
+void *
+realloc(void *p, size_t len)
+{
+        size_t olen;
+        void *np;
+
+        if (b_realloc == NULL) {
+                if (booting)
+                        return (NULL);
+                b_init();
+        }
+        ++nallocs;
+        if (!INBOOT(p))
+                return (b_realloc(p, len));
+        olen = boot + sizeof(boot) - (char *)p;
+        if ((np = b_malloc(len)) != NULL)
+                memcpy(np, p, len < olen ? len : olen);
+        return (np);
+}
+
+void
+free(void *p)
+{
+        if (p == NULL || INBOOT(p))
+                return;
+        if (b_free == NULL)
+                b_init();
+        b_free(p);
+}
+
+__attribute__((destructor)) static void
+b_done(void)
+{
+        FILE *fp;
+        unsigned long n;
+        char *path;
+
+        n = nallocs;
+        if ((path = getenv("BENCH_ALLOCS")) == NULL ||
+            (fp = fopen(path, "w")) == NULL)
+                return;
+        (void)fprintf(fp, "%lu\n", n);
+        (void)fclose(fp);
+}
@@ -0,0 +1,130 @@
+#!/usr/bin/env sh
+# SPDX-License-Identifier: BSD-3-Clause
+# Copyright (c) 2026 Jeffrey H. Johnson
+
+# Run scripted workloads through `ex -s` over generated files, and write
+# one line per workload: the corpus, the workload, the wall, user and
+# system seconds of the best of ${RUNS} runs, the peak resident set size
+# in KiB, and the number of allocations, or - if they couldn't be counted.
+# A workload that fails, e.g., on an ex error, is reported as all -'s, and
+# the script exits non-zero.
+#
+# usage: bench.sh [ex] [lines] [runs]
+
+BENCHD="$(dirname "${0:?}")"
+EX="${1:-${BENCHD:?}/../bin/ex}"
+NLINES="${2:-100000}"
+RUNS="${3:-3}"
+BRUN="${BRUN:-${BENCHD:?}/brun}"
+BALLOC="${BALLOC:-${BENCHD:?}/balloc.so}"
+TMPD="${TMPDIR:-/tmp}/vibench.$$"
+
+case "${EX:?}" in
+/*) ;;
+*)  EX="$(pwd)/${EX:?}" ;;
+esac
+case "${BRUN:?}" in
+/*) ;;
+*)  BRUN="$(pwd)/${BRUN:?}" ;;
+esac
+case "${BALLOC:?}" in
+/*) ;;
+*)  BALLOC="$(pwd)/${BALLOC:?}" ;;
+esac
+test -f "${BALLOC:?}" || BALLOC=""
+
+mkdir -p "${TMPD:?}" || exit 1
+trap 'rm -rf "${TMPD:?}"' EXIT
+trap 'exit 1' HUP INT TERM
+
+# Many short lines.
+awk -v n="${NLINES:?}" 'BEGIN {
+        for (i = 0; i < n; i++)
+                printf("%d foo bar %x baz\n", i, i * 7919)
+}' > "${TMPD:?}/short" || exit 1
+
+# A few huge lines, of about as many bytes in all.
+awk -v n="${NLINES:?}" 'BEGIN {
+        srand(1)
+        for (i = 0; i < 8; i++) {
+                for (j = 0; j < n / 8; j++)
+                        printf("%s%d ", (rand() < 0.1) ? "foo" : "w", j)
+                printf("\n")
+        }
+}' > "${TMPD:?}/huge" || exit 1
+
+# Log-like text.
+awk -v n="${NLINES:?}" 'BEGIN {
+        srand(2)
+        split("INFO DEBUG WARN ERROR", lv, " ")
+        split("http db cache auth foo", co, " ")
+        for (i = 0; i < n; i++)
+                printf("2026-01-%02d %02d:%02d:%02d.%03d %s [%s] " \
+                    "request %d took %dms from 10.0.%d.%d\n",
+                    i % 28 + 1, i / 3600 % 24, i / 60 % 60, i % 60, i % 1000,
+                    lv[int(rand() * 4) + 1], co[int(rand() * 5) + 1],
+                    i, int(rand() * 500), int(rand() * 256), i % 256)
+}' > "${TMPD:?}/log" || exit 1
+
+# Source-like text, with a tags file for its functions.
+awk -v n="${NLINES:?}" -v t="${TMPD:?}/tags.in" 'BEGIN {
+        for (i = 0; 8 * i < n; i++) {
+                printf("int\nfn%d(int foo, char *bar)\n{\n", i)
+                printf("\tint baz = foo * %d;\n\n", i)
+                printf("\tif (bar != NULL)\n\t\treturn (baz);\n")
+                printf("\treturn (fn%d(baz, bar));\n}\n", i / 2)
+                printf("fn%d\tsource\t/^fn%d(/\n", i, i) > t
+        }
+}' > "${TMPD:?}/source" || exit 1
+LC_ALL=C sort "${TMPD:?}/tags.in" > "${TMPD:?}/tags" || exit 1
+
+# rep count command: command, count times.
+rep()
+{
+        awk -v n="${1:?}" -v c="${2:?}" 'BEGIN {
+                for (i = 0; i < n; i++)
+                        print c
+        }'
+}
+
+# workload name: the ex commands of the workload.
+workload()
+{
+        case "${1:?}" in
+        load)       ;;
+        search)     rep 500 '/foo/' ;;
+        rsearch)    rep 500 '?foo?' ;;
+        global)     echo 'g/foo/s/o/0/' ;;
+        subst)      echo '%s/o/0/g' ;;
+        move)       rep 500 '1m$' ;;
+        undo)       echo '%s/o/O/g'; rep 10 'u' ;;
+        write)      rep 3 "w! ${TMPD:?}/out" ;;
+        read)       echo "\$r !cat ${TMPD:?}/log" ;;
+        tags)       echo "set tags=${TMPD:?}/tags"
+                    awk -v n="${NLINES:?}" 'BEGIN {
+                            srand(3)
+                            for (i = 0; i < 200; i++)
+                                    printf("tag fn%d\n", int(rand() * n / 8))
+                    }' ;;
+        esac
+        echo 'q!'
+}
+
+rval=0
+printf '%-8s %-8s %8s %8s %8s %10s %10s\n' \
+    "corpus" "workload" "wall" "user" "sys" "maxrss" "allocs"
+for c in short huge log source; do
+        for w in load search rsearch global subst move undo write read tags; do
+                test "${w:?}" = "tags" && test "${c:?}" != "source" && continue
+                workload "${w:?}" > "${TMPD:?}/script"
+                (cd "${TMPD:?}" &&
+                    "${BRUN:?}" ${BALLOC:+-a "${BALLOC:?}"} -n "${RUNS:?}" \
+                        -i "${TMPD:?}/script" -- "${EX:?}" -s "${c:?}") \
+                    > "${TMPD:?}/t" || rval=1
+                read -r wall user sys rss allocs < "${TMPD:?}/t"
+                printf '%-8s %-8s %8s %8s %8s %10s %10s\n' "${c:?}" "${w:?}" \
+                    "${wall:--}" "${user:--}" "${sys:--}" "${rss:--}" \
+                    "${allocs:--}"
+        done
+done
+exit "${rval:?}"
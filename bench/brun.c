@@ -0,0 +1,171 @@
+/* SPDX-License-Identifier: BSD-3-Clause */
+
+/*
+ * Copyright (c) 2026 Jeffrey H. Johnson
+ *
+ * See the LICENSE.md file for redistribution information.
+ */
+
+/*
+ * brun -- run a command a few times and report its best run
+ *
+ * usage: brun [-a library] [-i input] [-n runs] -- command [argument ...]
+ *
+ * The command reads the input file, /dev/null by default, and its output
+ * is discarded.  One line is written for the run with the least wall time:
+ *
+ *      wall user sys maxrss allocs
+ *
+ * with the times in seconds, the peak resident set size of the runs in KiB,
+ * and the allocations counted by the -a library (see balloc.c), or - if it
+ * couldn't be loaded.  If the command couldn't be run, or any run of it
+ * failed, the line is all -'s, and brun exits non-zero.
+ */
+
+#include <sys/types.h>
+#include <sys/resource.h>
+#include <sys/time.h>
+#include <sys/wait.h>
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+static double tv2d(struct timeval *);
+static void usage(void);
+
+int
+main(int argc, char *argv[])
+{
+        struct rusage r0, r1;
+        struct timeval t0, t1;
+        FILE *fp;
+        pid_t pid;
+        double best, bsys, buser, sys, user, wall;
+        long allocs, ballocs, maxrss;
+        int ch, fd, i, nruns, rval, status;
+        char *input, *lib, path[1024];
+
+        input = "/dev/null";
+        lib = NULL;
+        nruns = 1;
+        while ((ch = getopt(argc, argv, "a:i:n:")) != -1)
+                switch (ch) {
+                case 'a':
+                        lib = optarg;
+                        break;
+                case 'i':
+                        input = optarg;
+                        break;
+                case 'n':
+                        if ((nruns = atoi(optarg)) < 1)
+                                usage();
+                        break;
+                default:
+                        usage();
+                }
+        argc -= optind;
+        argv += optind;
+        if (argc == 0)
+                usage();
+
+        (void)snprintf(path, sizeof(path), "%s/brun.%ld",
+            getenv("TMPDIR") == NULL ? "/tmp" : getenv("TMPDIR"),
+            (long)getpid());
+
+        rval = 0;
+        best = bsys = buser = 0;
+        ballocs = -1;
+        for (i = 0; i < nruns; ++i) {
+                (void)unlink(path);
+                (void)getrusage(RUSAGE_CHILDREN, &r0);
+                (void)gettimeofday(&t0, NULL);
+                switch (pid = fork()) {
+                case -1:
+                        perror("brun: fork");
+                        return (1);
+                case 0:
+                        if ((fd = open(input, O_RDONLY)) == -1) {
+                                perror(input);
+                                _exit(127);
+                        }
+                        (void)dup2(fd, STDIN_FILENO);
+                        (void)close(fd);
+                        if ((fd = open("/dev/null", O_WRONLY)) != -1) {
+                                (void)dup2(fd, STDOUT_FILENO);
+                                (void)dup2(fd, STDERR_FILENO);
+                                (void)close(fd);
+                        }
+                        if (lib != NULL) {
+                                (void)setenv("LD_PRELOAD", lib, 1);
+                                (void)setenv("BENCH_ALLOCS", path, 1);
+                        }
+                        (void)execvp(argv[0], argv);
+                        _exit(127);
+                }
+                while (waitpid(pid, &status, 0) == -1)
+                        if (errno != EINTR) {
+                                perror("brun: waitpid");
+                                return (1);
+                        }
+                (void)gettimeofday(&t1, NULL);
+                (void)getrusage(RUSAGE_CHILDREN, &r1);
+                if (WIFSIGNALED(status)) {
+                        (void)fprintf(stderr, "brun: %s: killed by signal %d\n",
+                            argv[0], WTERMSIG(status));
+                        rval = 1;
+                } else if (WEXITSTATUS(status) != 0) {
+                        (void)fprintf(stderr, "brun: %s: exit status %d\n",
+                            argv[0], WEXITSTATUS(status));
+                        rval = 1;
+                }
+
+                wall = tv2d(&t1) - tv2d(&t0);
+                user = tv2d(&r1.ru_utime) - tv2d(&r0.ru_utime);
+                sys = tv2d(&r1.ru_stime) - tv2d(&r0.ru_stime);
+                allocs = -1;
+                if ((fp = fopen(path, "r")) != NULL) {
+                        if (fscanf(fp, "%ld", &allocs) != 1)
+                                allocs = -1;
+                        (void)fclose(fp);
+                }
+                if (i == 0 || wall < best) {
+                        best = wall;
+                        buser = user;
+                        bsys = sys;
+                        ballocs = allocs;
+                }
+        }
+        (void)unlink(path);
+
+        /* The children's peak, in bytes on macOS and KiB elsewhere. */
+        maxrss = r1.ru_maxrss;
+#ifdef __APPLE__
+        maxrss /= 1024;
+#endif /* ifdef __APPLE__ */
+        if (rval)
+                (void)printf("- - - - -\n");
+        else if (ballocs < 0)
+                (void)printf("%.3f %.3f %.3f %ld -\n",
+                    best, buser, bsys, maxrss);
+        else
+                (void)printf("%.3f %.3f %.3f %ld %ld\n",
+                    best, buser, bsys, maxrss, ballocs);
+        return (rval);
+}
+
+static double
+tv2d(struct timeval *tv)
+{
+        return (tv->tv_sec + tv->tv_usec / 1e6);
+}
+
+static void
+usage(void)
+{
+        (void)fprintf(stderr,
+            "usage: brun [-a library] [-i input] [-n runs] -- command ...\n");
+        exit(1);
+}
@@ -0,0 +1,70 @@
+#!/usr/bin/env sh
+# SPDX-License-Identifier: BSD-3-Clause
+# Copyright (c) 2026 Jeffrey H. Johnson
+
+# Measure :s throughput: substitutions per second of CPU time used by
+# `ex -s` running global substitutions over a generated file, less the
+# time it takes to read the file.
+#
+# usage: subst.sh [ex] [lines] [runs]
+
+EX="${1:-$(dirname "${0:?}")/../bin/ex}"
+NLINES="${2:-200000}"
+RUNS="${3:-3}"
+TMPD="${TMPDIR:-/tmp}/vibench.$$"
+
+mkdir -p "${TMPD:?}" || exit 1
+trap 'rm -rf "${TMPD:?}"' EXIT
+trap 'exit 1' HUP INT TERM
+
+# Every line has four matches.
+awk -v n="${NLINES:?}" 'BEGIN {
+        for (i = 0; i < n; i++)
+                printf("%d foo bar foo baz foo qux foo\n", i)
+}' > "${TMPD:?}/corpus" || exit 1
+
+# CPU seconds used by the children of this shell, from the output of times.
+cpu()
+{
+        awk 'NR == 2 {
+                for (i = 1; i <= 2; i++) {
+                        split($i, t, "m")
+                        s += t[1] * 60 + t[2]
+                }
+                printf("%.3f\n", s)
+        }' "${1:?}"
+}
+
+# run command: the least CPU seconds of ${RUNS} ex -s sessions running
+# command.  The times are those of the children of the (sub)shell running
+# the loop.
+run()
+{
+        r=0
+        while [ "${r:?}" -lt "${RUNS:?}" ]; do
+                times > "${TMPD:?}/t0"
+                printf '%s\nq!\n' "${1:?}" |
+                    "${EX:?}" -s "${TMPD:?}/corpus" > /dev/null 2>&1
+                times > "${TMPD:?}/t1"
+                awk -v a="$(cpu "${TMPD:?}/t0")" -v b="$(cpu "${TMPD:?}/t1")" \
+                    'BEGIN { printf("%.3f\n", b - a) }'
+                r=$((r + 1))
+        done | sort -n | head -n 1
+}
+
+run 'set nomodeline' > "${TMPD:?}/load"
+load=$(cat "${TMPD:?}/load")
+printf '%-12s %10s %8s %12s\n' "workload" "subs" "seconds" "subs/second"
+for w in 'literal:%s/foo/FOO/g'                                       \
+         'groups:%s/\(f\)\(o*\)/\2\1/g'                               \
+         'case:%s/foo/\u&-\U&\E/g'; do
+        run "${w#*:}" > "${TMPD:?}/t"
+        t=$(cat "${TMPD:?}/t")
+        awk -v w="${w%%:*}" -v n="$((NLINES * 4))" -v t="${t:?}"     \
+            -v l="${load:?}" 'BEGIN {
+                s = t - l
+                if (s <= 0)
+                        s = 0.001
+                printf("%-12s %10d %8.3f %12.0f\n", w, n, s, n / s)
+        }'
+done
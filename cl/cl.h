@@ -17,9 +17,15 @@
 extern  volatile sig_atomic_t cl_sigint;
 extern  volatile sig_atomic_t cl_sigterm;
 extern  volatile sig_atomic_t cl_sigwinch;
+extern  volatile sig_atomic_t cl_sigusr1;
 
 typedef struct _cl_private {
         CHAR_T   ibuf[512];     /* Input keys. */
+        size_t   ioff;          /* Offset of unreturned input keys. */
+        size_t   ilen;          /* Length of unreturned input keys. */
+
+        CHAR_T  *pbuf;          /* Bracketed paste text. */
+        size_t   pbuf_len;      /* Bracketed paste buffer length. */
 
         int      eof_count;     /* EOF count. */
 
@@ -37,7 +43,8 @@ typedef struct _cl_private {
 #define INDX_INT        1
 #define INDX_TERM       2
 #define INDX_WINCH      3
-#define INDX_MAX        4       /* Original signal information. */
+#define INDX_USR1       4
+#define INDX_MAX        5       /* Original signal information. */
         struct sigaction oact[INDX_MAX];
 
         enum {                  /* Tty group write mode. */
@@ -52,6 +59,7 @@ typedef struct _cl_private {
 #define CL_SCR_EX_INIT  0x0008  /* Ex screen initialized. */
 #define CL_SCR_VI_INIT  0x0010  /* Vi screen initialized. */
 #define CL_STDIN_TTY    0x0020  /* Talking to a terminal. */
+#define CL_BPASTE       0x0040  /* Bracketed paste mode turned on. */
         u_int32_t flags;
 } CL_PRIVATE;
 
@@ -67,4 +75,11 @@ typedef enum { INP_OK=0, INP_EOF, INP_ERR, INP_INTR, INP_TIMEOUT } input_t;
 /* X11 xterm escape sequence to rename the icon/window. */
 #define XTERM_RENAME    "\033]0;%s\007"
 
+/* X11 xterm bracketed paste mode escape sequences. */
+#define XTERM_BPASTE_ON         "\033[?2004h"
+#define XTERM_BPASTE_OFF        "\033[?2004l"
+#define XTERM_PASTE_START       "\033[200~"
+#define XTERM_PASTE_END         "\033[201~"
+#define XTERM_PASTE_LEN         6
+
 #include "cl_extern.h"
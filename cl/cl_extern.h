@@ -37,6 +37,7 @@ int cl_addstr(SCR *, const char *, size_t);
 int cl_attr(SCR *, scr_attr_t, int);
 int cl_baud(SCR *, unsigned long *);
 int cl_bell(SCR *);
+int cl_bpaste(SCR *, int);
 int cl_clrtoeol(SCR *);
 int cl_cursor(SCR *, size_t *, size_t *);
 int cl_deleteln(SCR *);
@@ -70,6 +70,7 @@ cl_addstr(SCR *sp, const char *str, size_t len)
 
         if (addnstr(str, len) == ERR)
                 return (1);
+        sp->gp->scr_bytes += len;
 
         if (iv)
                 (void)standend();
@@ -234,6 +235,40 @@ cl_bell(SCR *sp)
         return (0);
 }
 
+/*
+ * cl_bpaste --
+ *      Turn the terminal's bracketed paste mode on or off.
+ *
+ * PUBLIC: int cl_bpaste(SCR *, int);
+ */
+int
+cl_bpaste(SCR *sp, int on)
+{
+        CL_PRIVATE *clp;
+
+        clp = CLP(sp);
+
+        /*
+         * XXX
+         * There's no terminfo capability for bracketed paste mode.  The
+         * sequences are xterm's, and terminals that don't know them are
+         * expected to ignore them.
+         */
+        if (on) {
+                if (!F_ISSET(clp, CL_BPASTE) && F_ISSET(clp, CL_STDIN_TTY)) {
+                        F_SET(clp, CL_BPASTE);
+                        (void)printf(XTERM_BPASTE_ON);
+                        (void)fflush(stdout);
+                }
+        } else
+                if (F_ISSET(clp, CL_BPASTE)) {
+                        F_CLR(clp, CL_BPASTE);
+                        (void)printf(XTERM_BPASTE_OFF);
+                        (void)fflush(stdout);
+                }
+        return (0);
+}
+
 /*
  * cl_clrtoeol --
  *      Clear from the current cursor to the end of the line.
@@ -607,6 +642,9 @@ cl_suspend(SCR *sp, int *allowedp)
         /* Restore the window name. */
         (void)cl_rename(sp, NULL, 0);
 
+        /* Turn off bracketed paste mode. */
+        (void)cl_bpaste(sp, 0);
+
         (void)endwin();
 
         /*
@@ -639,6 +677,10 @@ cl_suspend(SCR *sp, int *allowedp)
         /* Put the cursor keys into application mode. */
         (void)keypad(stdscr, TRUE);
 
+        /* Turn bracketed paste mode back on. */
+        if (O_ISSET(sp, O_BRACKETPASTE))
+                (void)cl_bpaste(sp, 1);
+
         /* Refresh and repaint the screen. */
         (void)move(oldy, oldx);
         (void)cl_refresh(sp, 1);
@@ -54,6 +54,7 @@ GS *__global_list;                              /* GLOBAL: List of screens. */
 volatile sig_atomic_t cl_sigint;
 volatile sig_atomic_t cl_sigterm;
 volatile sig_atomic_t cl_sigwinch;
+volatile sig_atomic_t cl_sigusr1;
 
 static void        cl_func_std(GS *);
 static CL_PRIVATE *cl_init(GS *);
@@ -78,6 +79,11 @@ main(int argc, char *argv[])
         /* Create and initialize the global structure. */
         __global_list = gp = gs_init();
 
+        /* Time the startup phases if VISTARTUP is set. */
+        if (getenv("VISTARTUP") != NULL)
+                F_SET(gp, G_STARTUP);
+        v_phase(gp, "start");
+
         /* Create and initialize the CL_PRIVATE structure. */
         clp = cl_init(gp);
 
@@ -112,6 +118,7 @@ main(int argc, char *argv[])
         /* Start catching signals. */
         if (sig_init(gp, NULL))
                 exit (1);
+        v_phase(gp, "terminal");
 
         /* Run ex/vi. */
         rval = editor(gp, argc, argv);
@@ -147,6 +154,7 @@ main(int argc, char *argv[])
 
         /* Free the global and CL private areas. */
 #if defined(DEBUG) || defined(PURIFY)
+        free(clp->pbuf);
         free(clp);
         free(gp);
 #endif /* if defined(DEBUG) || defined(PURIFY) */
@@ -262,6 +270,12 @@ h_winch(int signo)
         cl_sigwinch = 1;
 }
 
+static void
+h_usr1(int signo)
+{
+        cl_sigusr1 = 1;
+}
+
 /*
  * sig_init --
  *      Initialize signals.
@@ -278,13 +292,15 @@ sig_init(GS *gp, SCR *sp)
         cl_sigint   = 0;
         cl_sigterm  = 0;
         cl_sigwinch = 0;
+        cl_sigusr1  = 0;
 
         if (sp == NULL) {
                 if (setsig(SIGHUP,   &clp->oact[INDX_HUP],   h_term) ||
                     setsig(SIGINT,   &clp->oact[INDX_INT],   h_int)  ||
                     setsig(SIGQUIT,  &clp->oact[INDX_INT],   h_int)  ||
                     setsig(SIGTERM,  &clp->oact[INDX_TERM],  h_term) ||
-                    setsig(SIGWINCH, &clp->oact[INDX_WINCH], h_winch)
+                    setsig(SIGWINCH, &clp->oact[INDX_WINCH], h_winch) ||
+                    setsig(SIGUSR1,  &clp->oact[INDX_USR1],  h_usr1)
                     )
                         openbsd_err(1, NULL);
         } else
@@ -292,7 +308,8 @@ sig_init(GS *gp, SCR *sp)
                     setsig(SIGINT,   NULL, h_int)  ||
                     setsig(SIGQUIT,  NULL, h_int)  ||
                     setsig(SIGTERM,  NULL, h_term) ||
-                    setsig(SIGWINCH, NULL, h_winch)
+                    setsig(SIGWINCH, NULL, h_winch) ||
+                    setsig(SIGUSR1,  NULL, h_usr1)
                     ) {
                         msgq(sp, M_SYSERR, "signal-reset");
                 }
@@ -336,6 +353,7 @@ sig_end(GS *gp)
         (void)sigaction(SIGQUIT,  NULL, &clp->oact[INDX_INT]);
         (void)sigaction(SIGTERM,  NULL, &clp->oact[INDX_TERM]);
         (void)sigaction(SIGWINCH, NULL, &clp->oact[INDX_WINCH]);
+        (void)sigaction(SIGUSR1,  NULL, &clp->oact[INDX_USR1]);
 }
 
 /*
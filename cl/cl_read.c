@@ -58,6 +58,8 @@
 # undef columns
 #endif /* if defined(_AIX) || defined(__illumos__) */
 
+static int      cl_paste(SCR *, EVENT *, u_int32_t);
+static size_t   cl_pfind(CHAR_T *, size_t, const char *);
 static input_t  cl_read(SCR *,
                     u_int32_t, CHAR_T *, size_t, int *, struct timeval *);
 static int      cl_resize(SCR *sp, size_t lines, size_t columns);
@@ -110,6 +112,10 @@ retest: if (LF_ISSET(EC_INTERRUPT) || cl_sigint) {
                 }
                 /* No real change, ignore the signal. */
         }
+        if (cl_sigusr1) {
+                cl_sigusr1 = 0;
+                stats_signal(sp);
+        }
 
         /* Set timer. */
         if (ms == 0)
@@ -120,31 +126,189 @@ retest: if (LF_ISSET(EC_INTERRUPT) || cl_sigint) {
                 tp = &t;
         }
 
-        /* Read input characters. */
-        switch (cl_read(sp, LF_ISSET(EC_QUOTED | EC_RAW),
-            clp->ibuf, sizeof(clp->ibuf), &nr, tp)) {
-        case INP_OK:
-                evp->e_csp = clp->ibuf;
-                evp->e_len = nr;
+        /*
+         * Read input characters, unless there are some left over from
+         * the read that returned the last paste.
+         */
+        if (clp->ilen == 0) {
+                switch (cl_read(sp, LF_ISSET(EC_QUOTED | EC_RAW),
+                    clp->ibuf, sizeof(clp->ibuf), &nr, tp)) {
+                case INP_OK:
+                        clp->ioff = 0;
+                        clp->ilen = nr;
+                        break;
+                case INP_EOF:
+                        evp->e_event = E_EOF;
+                        return (0);
+                case INP_ERR:
+                        evp->e_event = E_ERR;
+                        return (0);
+                case INP_INTR:
+                        goto retest;
+                case INP_TIMEOUT:
+                        evp->e_event = E_TIMEOUT;
+                        return (0);
+                default:
+                        abort();
+                }
+        }
+
+        /*
+         * In bracketed paste mode, the terminal wraps pasted text in start
+         * and end sequences.  Return the keys before a start sequence, or
+         * the pasted text, as a separate event.  This is done even if the
+         * next key is to be quoted, it's the first pasted key that's quoted,
+         * not the start sequence.  An empty paste returns nothing, go back
+         * for more input.
+         */
+        if (F_ISSET(clp, CL_BPASTE)) {
+                if (cl_paste(sp, evp, flags))
+                        return (1);
+                if (evp->e_event == E_NOTUSED)
+                        goto retest;
+                return (0);
+        }
+
+        evp->e_csp = clp->ibuf + clp->ioff;
+        evp->e_len = clp->ilen;
+        evp->e_event = E_STRING;
+        clp->ilen = 0;
+        return (0);
+}
+
+/*
+ * cl_paste --
+ *      Return the keys in front of a paste, or the pasted text.
+ */
+static int
+cl_paste(SCR *sp, EVENT *evp, u_int32_t flags)
+{
+        struct timeval t;
+        CL_PRIVATE *clp;
+        size_t len, off, plen, rest;
+        int lost, nr;
+
+        clp = CLP(sp);
+
+        /*
+         * Look for the start sequence.  If the keys end in the first part
+         * of one, the terminal's write was split: wait briefly for the rest
+         * of it.  Only do this for the "\033[" prefix and up, a lone <escape>
+         * at the end of a read is almost always the user's.
+         */
+        for (;;) {
+                len = clp->ilen;
+                off = cl_pfind(clp->ibuf + clp->ioff, len, XTERM_PASTE_START);
+                if (off + XTERM_PASTE_LEN <= len || len - off < 2)
+                        break;
+                if (clp->ioff != 0) {
+                        memmove(clp->ibuf, clp->ibuf + clp->ioff, len);
+                        clp->ioff = 0;
+                }
+                t.tv_sec = 0;
+                t.tv_usec = O_VAL(sp, O_ESCAPETIME) * 100000;
+                if (len + XTERM_PASTE_LEN >= sizeof(clp->ibuf) ||
+                    cl_read(sp, 0, clp->ibuf + len,
+                    sizeof(clp->ibuf) - len, &nr, &t) != INP_OK) {
+                        off = len;
+                        break;
+                }
+                clp->ilen += nr;
+        }
+        if (off + XTERM_PASTE_LEN > len)
+                off = len;
+
+        /* Return the keys in front of the start sequence. */
+        if (off != 0) {
+                evp->e_csp = clp->ibuf + clp->ioff;
+                evp->e_len = off;
                 evp->e_event = E_STRING;
+                clp->ioff += off;
+                clp->ilen -= off;
+                return (0);
+        }
+        clp->ioff += XTERM_PASTE_LEN;
+        clp->ilen -= XTERM_PASTE_LEN;
+
+        /*
+         * Copy the pasted text until the end sequence, which may be split
+         * across reads, so search back from the end of the copied text.
+         * Keys following the end sequence came from the last read, and are
+         * put back in the input buffer.  If interrupted, return what we
+         * have and let the rest of the paste be read as ordinary keys.  If
+         * the terminal goes quiet for escapetime without sending the end
+         * sequence, it may have been lost on the way; rather than wait for
+         * it forever, return what we have as ordinary keys.
+         */
+        t.tv_sec = 0;
+        t.tv_usec = O_VAL(sp, O_ESCAPETIME) * 100000;
+        for (lost = 0, plen = 0;;) {
+                BINC_RET(sp, clp->pbuf, clp->pbuf_len, plen + clp->ilen);
+                memcpy(clp->pbuf + plen, clp->ibuf + clp->ioff, clp->ilen);
+                off = plen < XTERM_PASTE_LEN ? 0 : plen - XTERM_PASTE_LEN + 1;
+                plen += clp->ilen;
+                clp->ilen = 0;
+                off += cl_pfind(clp->pbuf + off, plen - off, XTERM_PASTE_END);
+                if (off + XTERM_PASTE_LEN <= plen) {
+                        rest = plen - (off + XTERM_PASTE_LEN);
+                        memcpy(clp->ibuf,
+                            clp->pbuf + off + XTERM_PASTE_LEN, rest);
+                        clp->ioff = 0;
+                        clp->ilen = rest;
+                        plen = off;
+                        break;
+                }
+                switch (cl_read(sp, 0,
+                    clp->ibuf, sizeof(clp->ibuf), &nr, &t)) {
+                case INP_OK:
+                        clp->ioff = 0;
+                        clp->ilen = nr;
+                        continue;
+                case INP_INTR:
+                        if (!cl_sigint && !cl_sigterm)
+                                continue;
+                        break;
+                case INP_TIMEOUT:
+                        lost = 1;
+                        break;
+                default:
+                        break;
+                }
                 break;
-        case INP_EOF:
-                evp->e_event = E_EOF;
-                break;
-        case INP_ERR:
-                evp->e_event = E_ERR;
-                break;
-        case INP_INTR:
-                goto retest;
-        case INP_TIMEOUT:
-                evp->e_event = E_TIMEOUT;
-                break;
-        default:
-                abort();
         }
+
+        if (plen == 0) {
+                evp->e_event = E_NOTUSED;
+                return (0);
+        }
+        evp->e_csp = clp->pbuf;
+        evp->e_len = plen;
+        evp->e_event = LF_ISSET(EC_PASTE) && !lost ? E_PASTE : E_STRING;
         return (0);
 }
 
+/*
+ * cl_pfind --
+ *      Return the offset of a paste sequence, or of its first part at the
+ *      end of the keys, or the length of the keys if there's neither.
+ */
+static size_t
+cl_pfind(CHAR_T *p, size_t len, const char *seq)
+{
+        size_t off, n;
+
+        for (off = 0; off < len; ++off) {
+                if (p[off] != '\033')
+                        continue;
+                for (n = 1; n < XTERM_PASTE_LEN &&
+                    off + n < len && p[off + n] == (CHAR_T)seq[n]; ++n)
+                        ;
+                if (n == XTERM_PASTE_LEN || off + n == len)
+                        return (off);
+        }
+        return (len);
+}
+
 /*
  * cl_read --
  *      Read characters from the input.
@@ -97,6 +97,9 @@ cl_screen(SCR *sp, u_int32_t flags)
         if (F_ISSET(sp, SC_SCR_VI)) {
                 F_CLR(sp, SC_SCR_VI);
 
+                /* Ex reads pasted text as ordinary input. */
+                (void)cl_bpaste(sp, 0);
+
                 if (TAILQ_NEXT(sp, q)) {
                         (void)move(RLNO(sp, sp->rows), 0);
                         clrtobot();
@@ -373,6 +376,10 @@ fast:   /* Set the terminal modes. */
 err:            (void)cl_vi_end(sp->gp);
                 return (1);
         }
+
+        /* Have the terminal mark the start and end of pasted text. */
+        if (O_ISSET(sp, O_BRACKETPASTE))
+                (void)cl_bpaste(sp, 1);
         return (0);
 }
 
@@ -390,6 +397,13 @@ cl_vi_end(GS *gp)
         /* Restore the cursor keys to normal mode. */
         (void)keypad(stdscr, FALSE);
 
+        /* Turn off bracketed paste mode. */
+        if (F_ISSET(clp, CL_BPASTE)) {
+                F_CLR(clp, CL_BPASTE);
+                (void)printf(XTERM_BPASTE_OFF);
+                (void)fflush(stdout);
+        }
+
         /*
          * If we were running vi when we quit, scroll the screen up a single
          * line so we don't lose any information.
@@ -230,6 +230,12 @@ cl_optchange(SCR *sp, int opt, char *str, unsigned long *valp)
                  */
                 F_SET(sp->gp, G_SRESTART);
                 break;
+        case O_BRACKETPASTE:
+                if (*valp)
+                        (void)cl_bpaste(sp, 0);
+                else if (F_ISSET(sp, SC_SCR_VI))
+                        (void)cl_bpaste(sp, 1);
+                break;
         case O_MESG:
                 (void)cl_omesg(sp, clp, !*valp);
                 break;
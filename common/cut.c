@@ -324,6 +324,22 @@ text_init(SCR *sp, const char *p, size_t len, size_t total_len)
         return (tp);
 }
 
+/*
+ * text_gapclose --
+ *      Close the gap the text input code leaves after the cursor, moving
+ *      the rest of the line back down against it.
+ *
+ * PUBLIC: void text_gapclose(TEXT *);
+ */
+void
+text_gapclose(TEXT *tp)
+{
+        if (tp->gap == 0)
+                return;
+        memmove(tp->lb + tp->cno, tp->lb + tp->cno + tp->gap, tp->insert);
+        tp->gap = 0;
+}
+
 /*
  * text_lfree --
  *      Free a chain of text structures.
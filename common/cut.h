@@ -40,6 +40,7 @@ struct _text {                          /* Text: a linked list of lines. */
         size_t   cno;                   /* 0-N: file character in line. */
         size_t   ai;                    /* 0-N: autoindent bytes. */
         size_t   insert;                /* 0-N: bytes to insert (push). */
+        size_t   gap;                   /* 0-N: gap after the cursor. */
         size_t   offset;                /* 0-N: initial, unerasable chars. */
         size_t   owrite;                /* 0-N: chars to overwrite. */
         size_t   R_erase;               /* 0-N: 'R' erase count. */
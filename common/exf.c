@@ -137,7 +137,7 @@ file_init(SCR *sp, FREF *frp, char *rcv_name, int flags)
         RECNOINFO oinfo;
         struct stat sb;
         size_t psize;
-        int fd, exists, open_err, readonly;
+        int fd, exists, later, mapped, open_err, readonly;
         char *oname, tname[] = "/tmp/vi.XXXXXX";
 
         open_err = readonly = 0;
@@ -256,11 +256,31 @@ file_init(SCR *sp, FREF *frp, char *rcv_name, int flags)
 
         ep->mtim = sb.st_mtim;
 
+        /*
+         * A read-only session (view or -R) on an existing file reads its
+         * lines straight from a mapping of the file until the buffer is
+         * first modified, which saves loading the file into the database
+         * just to look at it.  The mapping replaces the snapshot.
+         */
+        mapped = F_ISSET(sp, SC_READONLY) &&
+            rcv_name == NULL && exists && !LF_ISSET(FS_OPENERR);
+
+        /*
+         * In vi, the snapshot is put off until the first screen of the file
+         * has been painted (see vi()), so that the screen doesn't wait for
+         * the rest of the file to be read.
+         */
+        later = F_ISSET(sp->gp, G_SNAPSHOT) && !mapped &&
+            F_ISSET(sp, SC_VI) && rcv_name == NULL && exists;
+
         /* Set up recovery. */
         memset(&oinfo, 0, sizeof(RECNOINFO));
         oinfo.bval = '\n';                      /* Always set. */
         oinfo.psize = psize;
-        oinfo.flags = F_ISSET(sp->gp, G_SNAPSHOT) ? R_SNAPSHOT : 0;
+        oinfo.flags =
+            F_ISSET(sp->gp, G_SNAPSHOT) && !mapped && !later ? R_SNAPSHOT : 0;
+        oinfo.zcachesize = O_VAL(sp, O_ZCACHE) > UINT_MAX / 1024 ?
+            UINT_MAX : O_VAL(sp, O_ZCACHE) * 1024;
 #ifndef NO_BFNAME
         if (rcv_name == NULL) {
                 if (!rcv_tmp(sp, ep, frp->name))
@@ -422,6 +442,19 @@ file_init(SCR *sp, FREF *frp, char *rcv_name, int flags)
         else
                 O_CLR(sp, O_READONLY);
 
+        /*
+         * Without a snapshot, the database reads the file as lines are
+         * asked for, and counting them reads all of it; see db_last_est().
+         */
+        if (!(oinfo.flags & R_SNAPSHOT))
+                F_SET(ep, F_READLAZY);
+        if (later)
+                F_SET(ep, F_SNAPSHOT);
+
+        /* Map the file; see above. */
+        if (mapped)
+                (void)db_mmap(sp, ep, ep->db->fd(ep->db));
+
         /* Switch... */
         ++ep->refcnt;
         sp->ep = ep;
@@ -710,6 +743,7 @@ file_end(SCR *sp, EXF *ep, int force)
          *
          * Close the db structure.
          */
+        stats_fold(sp->gp, ep);
         if (ep->db->close != NULL && ep->db->close(ep->db) && !force) {
                 if (frp)
                     msgq_str(sp, M_SYSERR, frp->name, "%s: close");
@@ -749,6 +783,7 @@ file_end(SCR *sp, EXF *ep, int force)
         free(ep->rcv_path);
         free(ep->rcv_mpath);
         free(ep->c_buf);
+        db_munmap(sp, ep);
         free(ep);
         return (0);
 }
@@ -770,6 +805,7 @@ file_write(SCR *sp, MARK *fm, MARK *tm, char *name, int flags)
         FILE *fp;
         FREF *frp;
         MARK from, to;
+        recno_t lno;
         size_t len;
         unsigned long nlno, nch;
         int fd, nf, noname, oflags, rval;
@@ -848,6 +884,17 @@ file_write(SCR *sp, MARK *fm, MARK *tm, char *name, int flags)
                 mtype = OLDFILE;
         }
 
+        /*
+         * If the lines are still being read from a mapping of the file we're
+         * about to truncate, load them into the database first.
+         */
+        if (ep->m_base != NULL && !LF_ISSET(FS_APPEND) && !stat(name, &sb) &&
+            sb.st_dev == ep->mdev && sb.st_ino == ep->minode) {
+                db_munmap(sp, ep);
+                if (db_last(sp, &lno))
+                        return (1);
+        }
+
         /* Set flags to create, write, and either append or truncate. */
         oflags = O_CREAT | O_WRONLY |
             (LF_ISSET(FS_APPEND) ? O_APPEND : O_TRUNC);
@@ -1190,6 +1237,72 @@ err:    if (rfd != -1)
         return (1);
 }
 
+/*
+ * The comment option looks at no more than CMT_MAXLINES lines and
+ * CMT_MAXBYTES bytes at the start of the file, read from the file itself
+ * in CMT_CHUNK byte chunks, so that a huge or unterminated leading comment
+ * doesn't make the database read all of the file before it's displayed.
+ */
+#define CMT_CHUNK       (8 * 1024)
+#define CMT_MAXBYTES    (64 * 1024)
+#define CMT_MAXLINES    1000
+
+typedef struct {
+        SCR     *sp;
+        int      fd;            /* File, or -1 to ask the database. */
+        int      eof;           /* Read to the end of the file. */
+        char    *bp;            /* Bytes read from the file. */
+        size_t   len;           /* Length of bp. */
+        size_t   off;           /* Offset of the next line in bp. */
+        recno_t  lno;           /* Last line returned. */
+} CMTSCAN;
+
+/*
+ * file_cline --
+ *      Return the next line of the file to file_comment, or 1 if there
+ *      isn't one or the scan has gone far enough.
+ */
+static int
+file_cline(CMTSCAN *csp, char **pp, size_t *lenp)
+{
+        size_t n;
+        ssize_t nr;
+        char *p;
+
+        if (csp->lno >= CMT_MAXLINES)
+                return (1);
+        ++csp->lno;
+        if (csp->fd == -1)
+                return (db_get(csp->sp, csp->lno, 0, pp, lenp));
+
+        while ((p = memchr(csp->bp + csp->off,
+            '\n', csp->len - csp->off)) == NULL) {
+                /* The last line of the file may not end in a newline. */
+                if (csp->eof) {
+                        if (csp->off == csp->len)
+                                return (1);
+                        p = csp->bp + csp->len;
+                        break;
+                }
+                if ((n = CMT_MAXBYTES - csp->len) == 0)
+                        return (1);
+                if (n > CMT_CHUNK)
+                        n = CMT_CHUNK;
+                if ((nr = pread(csp->fd,
+                    csp->bp + csp->len, n, (off_t)csp->len)) == -1)
+                        return (1);
+                if (nr == 0)
+                        csp->eof = 1;
+                csp->len += nr;
+        }
+        *pp = csp->bp + csp->off;
+        *lenp = p - *pp;
+        csp->off = p - csp->bp;
+        if (csp->off < csp->len)
+                ++csp->off;             /* Skip the newline. */
+        return (0);
+}
+
 /*
  * file_comment --
  *      Skip the first comment.
@@ -1197,29 +1310,44 @@ err:    if (rfd != -1)
 static void
 file_comment(SCR *sp)
 {
-        recno_t lno;
+        struct stat sb;
+        CMTSCAN cs;
+        EXF *ep;
         size_t len;
         char *p;
 
-        for (lno = 1; !db_get(sp, lno, 0, &p, &len) && len == 0; ++lno);
-        if (p == NULL)
-                return;
+        /*
+         * Scan an unmodified regular file's own bytes; the lines of anything
+         * else come from the database, which already has them.
+         */
+        ep = sp->ep;
+        memset(&cs, 0, sizeof(cs));
+        cs.sp = sp;
+        if (F_ISSET(ep, F_MODIFIED) || (cs.fd = ep->db->fd(ep->db)) == -1 ||
+            fstat(cs.fd, &sb) || !S_ISREG(sb.st_mode) ||
+            (cs.bp = malloc(CMT_MAXBYTES)) == NULL)
+                cs.fd = -1;
+
+        do {
+                if (file_cline(&cs, &p, &len))
+                        goto done;
+        } while (len == 0);
         if (p[0] == '#') {
                 F_SET(sp, SC_SCR_TOP);
-                while (!db_get(sp, ++lno, 0, &p, &len))
+                while (!file_cline(&cs, &p, &len))
                         if (len < 1 || p[0] != '#') {
-                                sp->lno = lno;
-                                return;
+                                sp->lno = cs.lno;
+                                goto done;
                         }
         } else if (len > 1 && p[0] == '/' && p[1] == '*') {
                 F_SET(sp, SC_SCR_TOP);
                 do {
                         for (; len > 1; --len, ++p)
                                 if (p[0] == '*' && p[1] == '/') {
-                                        sp->lno = lno;
-                                        return;
+                                        sp->lno = cs.lno;
+                                        goto done;
                                 }
-                } while (!db_get(sp, ++lno, 0, &p, &len));
+                } while (!file_cline(&cs, &p, &len));
         } else if (len > 1 && p[0] == '/' && p[1] == '/') {
                 F_SET(sp, SC_SCR_TOP);
                 p += 2;
@@ -1227,11 +1355,12 @@ file_comment(SCR *sp)
                 do {
                         for (; len > 1; --len, ++p)
                                 if (p[0] == '/' && p[1] == '/') {
-                                        sp->lno = lno;
-                                        return;
+                                        sp->lno = cs.lno;
+                                        goto done;
                                 }
-                } while (!db_get(sp, ++lno, 0, &p, &len));
+                } while (!file_cline(&cs, &p, &len));
         }
+done:   free(cs.bp);
 }
 
 /*
@@ -37,8 +37,25 @@ struct _exf {
         size_t   c_len;                 /* Cached line length. */
         recno_t  c_lno;                 /* Cached line number. */
         recno_t  c_nlines;              /* Cached lines in the file. */
+        recno_t  c_elines;              /* Estimated lines in the file. */
         char    *c_buf;                 /* Buffer used for line cache. */
         size_t  c_buf_len;              /* Length of line cache buffer. */
+        unsigned long c_gen;            /* Count of changes to lines. */
+
+                                        /* Read-only file mapping; line.c. */
+#define M_STRIDE        1024            /* Lines between index entries. */
+        char    *m_base;                /* Mapped file. */
+        size_t   m_len;                 /* Mapped file length. */
+        size_t  *m_idx;                 /* Offset of every M_STRIDE'th line. */
+        size_t   m_idxcnt;              /* Index entries filled in. */
+        size_t   m_idxlen;              /* Index entries allocated. */
+        recno_t  m_nlines;              /* Lines in the file, if m_eof. */
+        int      m_eof;                 /* Index reached the end of file. */
+        recno_t  m_clno;                /* Last line looked up... */
+        size_t   m_coff;                /* ...and its offset. */
+        int      m_cached;              /* Index came from the line cache. */
+        int      m_fault;               /* Mapping is past the file's end. */
+        struct _exf *m_next;            /* Next mapped file. */
 
         DB      *log;                   /* Log db structure. */
         char    *l_lp;                  /* Log buffer. */
@@ -77,6 +94,8 @@ struct _exf {
 #define F_RCV_ON        0x040           /* Recovery is possible. */
 #define F_UNDO          0x080           /* No change since last undo. */
 #define F_RCV_SYNC      0x100           /* Recovery file sync needed. */
+#define F_READLAZY      0x200           /* Db reads the file on demand. */
+#define F_SNAPSHOT      0x400           /* Snapshot still to be taken. */
         u_int16_t flags;
 };
 
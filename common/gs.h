@@ -113,6 +113,59 @@ struct _gs {
         CB       dcb_store;             /* Default cut buffer storage. */
         LIST_HEAD(_cuth, _cb) cutq;     /* Linked list of cut buffers. */
 
+                                        /* Compiled REs, most recent first. */
+        TAILQ_HEAD(_rech, _recache) rech;
+        unsigned long re_hits;          /* Compiled RE lookups found. */
+        unsigned long re_misses;        /* Compiled RE lookups compiled. */
+
+                                        /* Counters reported by :stats. */
+        unsigned long long re_cnsec;    /* Nanoseconds compiling REs.   */
+        unsigned long re_execs;         /* RE executions.               */
+        unsigned long long re_ensec;    /* Nanoseconds executing REs.   */
+        unsigned long db_hits;          /* Lines found in a cache.      */
+        unsigned long db_misses;        /* Lines read from a file.      */
+        unsigned long db_changes;       /* Lines changed.               */
+        unsigned long rcv_syncs;        /* Recovery file syncs.         */
+        unsigned long long rcv_nsec;    /* Longest sync, nanoseconds.   */
+        unsigned long long scr_bytes;   /* Bytes written to the screen. */
+        DBSTAT   db_stat;               /* Closed files' buffer pools.  */
+        recno_t  log_recs;              /* Closed files' log records.   */
+        unsigned long long log_bytes;   /* Closed files' log bytes.     */
+
+#define MAX_PHASES      12              /* Startup phases timed. */
+        struct {
+                const char *name;       /* Phase name.            */
+                unsigned long long nsec;/* Time the phase ended.  */
+        } phases[MAX_PHASES];
+        int      nphases;               /* Startup phases ended.  */
+
+        /*
+         * Key to paint latency, in microseconds: a histogram with 8
+         * buckets for each power of two, and a ring of the slowest events.
+         */
+#define LAT_BUCKETS     256             /* Histogram buckets.         */
+#define LAT_RING        64              /* Slow events remembered.    */
+#define LAT_SLOW        50000           /* Slow event, microseconds.  */
+        unsigned long lat_hist[LAT_BUCKETS];
+        unsigned long lat_cnt;          /* Events measured.           */
+        unsigned long lat_max;          /* Slowest event.             */
+        unsigned long long lat_nsec;    /* First unpainted key, or 0. */
+        CHAR_T   lat_key;               /* Its key.                   */
+        CHAR_T   lat_cmd;               /* Current vi command.        */
+        unsigned long lat_gets;         /* db_get calls before it.    */
+        unsigned long lat_chgs;         /* Lines changed before it.   */
+        unsigned long long lat_bytes;   /* Bytes painted before it.   */
+        struct {
+                time_t   when;          /* Time of the key.           */
+                unsigned long usec;     /* Latency.                   */
+                CHAR_T   key;           /* Key.                       */
+                CHAR_T   cmd;           /* Vi command.                */
+                unsigned long gets;     /* db_get calls.              */
+                unsigned long chgs;     /* Lines changed.             */
+                unsigned long long bytes;/* Bytes painted.            */
+        } lat_ring[LAT_RING];
+        unsigned int lat_next;          /* Slow events recorded.      */
+
 #define MAX_BIT_SEQ     128             /* Max + 1 fast check character. */
         LIST_HEAD(_seqh, _seq) seqq;    /* Linked list of maps, abbrevs. */
         bitstr_t bit_decl(seqb, MAX_BIT_SEQ);
@@ -152,6 +205,8 @@ struct _gs {
 #define G_SNAPSHOT      0x0040          /* Always snapshot files.      */
 #define G_SRESTART      0x0080          /* Screen restarted.           */
 #define G_TMP_INUSE     0x0100          /* Temporary buffer in use.    */
+#define G_STATS         0x0200          /* Dump counters at exit.      */
+#define G_STARTUP       0x0400          /* Timing startup phases.      */
         u_int32_t flags;
 
         /* Screen interface functions... */
@@ -562,7 +562,7 @@ v_event_push(SCR *sp, EVENT *p_evp, CHAR_T *p_s, size_t nitems, unsigned int fla
 {
         EVENT *evp;
         GS *gp;
-        size_t total;
+        size_t shift, total;
 
         /* If we have room, stuff the items into the buffer. */
         gp = sp->gp;
@@ -575,19 +575,22 @@ v_event_push(SCR *sp, EVENT *p_evp, CHAR_T *p_s, size_t nitems, unsigned int fla
 
         /*
          * If there are currently items in the queue, shift them up,
-         * leaving some extra room.  Get enough space plus a little
-         * extra.
+         * leaving room in front of them for as many items again as the
+         * queue will hold, so that a run of pushes, e.g., the lines of
+         * an @ buffer, only shifts the queue a few times.  Get enough
+         * space for it.
          */
 #define TERM_PUSH_SHIFT 30
-        total = gp->i_cnt + gp->i_next + nitems + TERM_PUSH_SHIFT;
+        shift = MAXIMUM(TERM_PUSH_SHIFT, gp->i_cnt + nitems);
+        total = gp->i_cnt + nitems + shift;
         if (total >= gp->i_nelem && v_event_grow(sp, MAXIMUM(total, 64)))
                 return (1);
         if (gp == NULL)
                 return (1);
         if (gp->i_cnt)
-                MEMMOVE(gp->i_event + TERM_PUSH_SHIFT + nitems,
+                MEMMOVE(gp->i_event + shift + nitems,
                     gp->i_event + gp->i_next, gp->i_cnt);
-        gp->i_next = TERM_PUSH_SHIFT;
+        gp->i_next = shift;
 
         /* Put the new items into the queue. */
 copy:   gp->i_cnt += nitems;
@@ -622,8 +625,18 @@ v_event_append(SCR *sp, EVENT *argp)
         nevents = argp->e_event == E_STRING ? argp->e_len : 1;
         gp = sp->gp;
         if (gp->i_event == NULL ||
-            nevents > gp->i_nelem - (gp->i_next + gp->i_cnt))
-                v_event_grow(sp, MAXIMUM(nevents, 64));
+            nevents > gp->i_nelem - (gp->i_next + gp->i_cnt)) {
+                /*
+                 * If most of the buffer is the room left in front of the
+                 * queue by v_event_push, move the queue down into it.
+                 */
+                if (gp->i_next >= gp->i_cnt + nevents) {
+                        MEMMOVE(gp->i_event,
+                            gp->i_event + gp->i_next, gp->i_cnt);
+                        gp->i_next = 0;
+                } else
+                        v_event_grow(sp, MAXIMUM(nevents, 64));
+        }
         evp = gp->i_event + gp->i_next + gp->i_cnt;
         gp->i_cnt += nevents;
 
@@ -772,7 +785,8 @@ retry:  istimeout = remap_cnt = 0;
                 if (F_ISSET(gp, G_SCRWIN) && sscr_input(sp))
                         return (1);
 loop:           if (gp->scr_event(sp, argp,
-                    LF_ISSET(EC_INTERRUPT | EC_QUOTED | EC_RAW), timeout))
+                    LF_ISSET(EC_INTERRUPT | EC_QUOTED | EC_RAW) |
+                    (gp->i_cnt == 0 ? LF_ISSET(EC_PASTE) : 0), timeout))
                         return (1);
                 switch (argp->e_event) {
                 case E_ERR:
@@ -788,6 +802,14 @@ loop:           if (gp->scr_event(sp, argp,
                 case E_TIMEOUT:
                         istimeout = 1;
                         break;
+                case E_PASTE:
+                        /*
+                         * Pasted text is only returned as a single event to
+                         * callers that asked for it, and only when there's
+                         * nothing queued ahead of it.  The text belongs to
+                         * the screen, and is only valid until the next call.
+                         */
+                        return (0);
                 case E_INTERRUPT:
                         /* Set the global interrupt flag. */
                         F_SET(sp->gp, G_INTERRUPTED);
@@ -800,6 +822,7 @@ loop:           if (gp->scr_event(sp, argp,
                                 return (0);
                         goto append;
                 default:
+                        v_lat_key(sp, argp);
 append:                 if (v_event_append(sp, argp))
                                 return (1);
                         break;
@@ -985,6 +1008,9 @@ v_event_err(SCR *sp, EVENT *evp)
         case E_INTERRUPT:
                 msgq(sp, M_ERR, "Unexpected interrupt event");
                 break;
+        case E_PASTE:
+                msgq(sp, M_ERR, "Unexpected paste event");
+                break;
         case E_QUIT:
                 msgq(sp, M_ERR, "Unexpected quit event");
                 break;
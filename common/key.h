@@ -44,6 +44,7 @@ typedef enum {
         E_EOF,                          /* End of input (NOT ^D). */
         E_ERR,                          /* Input error. */
         E_INTERRUPT,                    /* Interrupt. */
+        E_PASTE,                        /* Pasted text: e_csp, e_len set. */
         E_QUIT,                         /* Quit. */
         E_REPAINT,                      /* Repaint: e_flno, e_tlno set. */
         E_SIGHUP,                       /* SIGHUP. */
@@ -180,6 +181,7 @@ extern KEYLIST keylist[];
 #define EC_QUOTED       0x010           /* Try to quote next character */
 #define EC_RAW          0x020           /* Any next character. XXX: not used. */
 #define EC_TIMEOUT      0x040           /* Timeout to next character. */
+#define EC_PASTE        0x080           /* Return pasted text as one event. */
 
 /* Flags describing text input special cases. */
 #define TXT_ADDNEWLINE  0x00000001      /* Replay starts on a new line. */
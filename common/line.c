@@ -12,20 +12,85 @@
  * See the LICENSE.md file for redistribution information.
  */
 
+#include "../include/compat.h"
+
 #include <sys/types.h>
+#include <sys/file.h>
+#include <sys/mman.h>
 #include <sys/queue.h>
+#include <sys/stat.h>
 #include <sys/time.h>
 
 #include <bitstring.h>
 #include <errno.h>
+#include <bsd_fcntl.h>
 #include <limits.h>
+#include <signal.h>
+#include <stdint.h>
 #include <stdio.h>
-#include <stdlib.h>
+#include <bsd_stdlib.h>
 #include <bsd_string.h>
+#include <time.h>
+#include <bsd_unistd.h>
 
 #include "common.h"
 #include "../vi/vi.h"
 
+/*
+ * The line index of a mapped file is saved across sessions in a hash
+ * database in the recovery directory, keyed by the file's device, inode,
+ * size and modification time.  Only files with enough lines to make the
+ * scan noticeable are saved, and the oldest entry is dropped once there
+ * are more than LIDX_MAXENT of them.
+ */
+#define LIDX_MAGIC      0x4c494458      /* "LIDX" */
+#define LIDX_MINIDX     64              /* Minimum index entries to save. */
+#define LIDX_MAXENT     64              /* Maximum files remembered. */
+
+/*
+ * Without the line count, db_last_est() estimates it from the newlines in
+ * up to EST_SAMPLE bytes from the start of the file.
+ */
+#define EST_SAMPLE      (64 * 1024)
+
+typedef struct {
+        u_int64_t dev;                  /* Device. */
+        u_int64_t ino;                  /* Inode. */
+        u_int64_t size;                 /* File size. */
+        int64_t   sec;                  /* Modification time. */
+        int64_t   nsec;                 /* ... */
+} LIDX_KEY;
+
+typedef struct {
+        u_int32_t magic;                /* LIDX_MAGIC. */
+        u_int32_t stride;               /* M_STRIDE. */
+        u_int32_t offsize;              /* sizeof(size_t). */
+        recno_t   nlines;               /* Lines in the file. */
+        size_t    idxcnt;               /* Index entries that follow. */
+        time_t    stamp;                /* When saved. */
+} LIDX_HDR;
+
+/*
+ * If another program truncates a mapped file, touching the pages past its
+ * new end raises SIGBUS.  While there are mappings, the handler replaces
+ * such a page with one of zeroes so the access can complete, and notes the
+ * fault; the mapping of the file that shrank is dropped at its next line
+ * lookup.
+ */
+static EXF *m_list;                     /* Mapped files. */
+static long m_pgsz;                     /* Page size. */
+static struct sigaction m_oact;         /* SIGBUS action to restore. */
+static volatile sig_atomic_t m_sigbus;  /* A mapped page was replaced. */
+
+static DB  *db_lidx_open(SCR *, int);
+static void db_lidx_key(EXF *, LIDX_KEY *);
+static void db_lidx_load(SCR *, EXF *);
+static void db_lidx_save(SCR *, EXF *);
+static int db_mextend(EXF *);
+static int db_mfault(EXF *);
+static int db_mget(EXF *, recno_t, char **, size_t *);
+static int db_mshrunk(EXF *);
+static void db_msigbus(int, siginfo_t *, void *);
 static int scr_update(SCR *, recno_t, lnop_t, int);
 
 /*
@@ -78,11 +143,34 @@ db_eget(SCR *sp, recno_t lno, char **pp, size_t *lenp, int *isemptyp)
 
 int
 db_get(SCR *sp, recno_t lno, u_int32_t flags, char **pp, size_t *lenp)
+{
+        return (db_gget(sp, lno, flags, pp, lenp, NULL, NULL));
+}
+
+/*
+ * db_gget --
+ *      Get a line, as db_get does.  If it's the line being input, and it's
+ *      split by a gap after the cursor, return the gap's offset and length
+ *      rather than closing it, so that screen code can redisplay the line
+ *      without copying it.
+ *
+ * PUBLIC: int db_gget(SCR *,
+ * PUBLIC:    recno_t, u_int32_t, char **, size_t *, size_t *, size_t *);
+ */
+
+int
+db_gget(SCR *sp, recno_t lno, u_int32_t flags,
+    char **pp, size_t *lenp, size_t *goffp, size_t *glenp)
 {
         DBT data, key;
         EXF *ep;
         TEXT *tp;
         recno_t l1, l2;
+        size_t mlen;
+        char *mp;
+
+        if (glenp != NULL)
+                *goffp = *glenp = 0;
 
         /*
          * The underlying recno stuff handles zero by returning NULL, but
@@ -111,9 +199,30 @@ db_get(SCR *sp, recno_t lno, u_int32_t flags, char **pp, size_t *lenp)
                 l1 = TAILQ_FIRST(&sp->tiq)->lno;
                 l2 = TAILQ_LAST(&sp->tiq, _texth)->lno;
                 if (l1 <= lno && l2 >= lno) {
-                        TAILQ_FOREACH(tp, &sp->tiq, q) {
-                                if (tp->lno == lno)
-                                        break;
+                        /*
+                         * The TEXT line numbers are consecutive.  Walk from
+                         * the last TEXT found, or from the nearer end of the
+                         * queue if that's closer: after a large paste, most
+                         * lookups are of the line next to the last one.
+                         */
+                        if ((tp = sp->tilast) == NULL ||
+                            (tp->lno > lno ? tp->lno - lno : lno - tp->lno) >
+                            (lno - l1 < l2 - lno ? lno - l1 : l2 - lno))
+                                tp = lno - l1 <= l2 - lno ?
+                                    TAILQ_FIRST(&sp->tiq) :
+                                    TAILQ_LAST(&sp->tiq, _texth);
+                        while (tp->lno < lno)
+                                tp = TAILQ_NEXT(tp, q);
+                        while (tp->lno > lno)
+                                tp = TAILQ_PREV(tp, _texth, q);
+                        sp->tilast = tp;
+                        ++sp->gp->db_hits;
+                        if (tp->gap != 0) {
+                                if (glenp != NULL) {
+                                        *goffp = tp->cno;
+                                        *glenp = tp->gap;
+                                } else if (pp != NULL)
+                                        text_gapclose(tp);
                         }
                         if (lenp != NULL)
                                 *lenp = tp->len;
@@ -133,6 +242,7 @@ db_get(SCR *sp, recno_t lno, u_int32_t flags, char **pp, size_t *lenp)
 
         /* Look-aside into the cache, and see if the line we want is there. */
         if (lno == ep->c_lno) {
+                ++sp->gp->db_hits;
                 if (lenp != NULL)
                         *lenp = ep->c_len;
                 if (pp != NULL)
@@ -142,6 +252,27 @@ db_get(SCR *sp, recno_t lno, u_int32_t flags, char **pp, size_t *lenp)
         ep->c_lno = OOBLNO;
 
 nocache:
+        ++sp->gp->db_misses;
+
+        /*
+         * Get the line from the file mapping, if there is one.  If the
+         * mapping can't be indexed any further, fall back to the database.
+         */
+        if (ep->m_base != NULL)
+                switch (db_mget(ep, lno, &mp, &mlen)) {
+                case 0:
+                        if (lenp != NULL)
+                                *lenp = mlen;
+                        if (pp != NULL)
+                                *pp = mp;
+                        return (0);
+                case 1:
+                        goto err1;
+                default:
+                        db_munmap(sp, ep);
+                        break;
+                }
+
         /* Get the line from the underlying database. */
         key.data = &lno;
         key.size = sizeof(lno);
@@ -188,6 +319,10 @@ db_delete(SCR *sp, recno_t lno)
                 return (1);
         }
 
+        /* The first change switches from the file mapping to the database. */
+        if (ep->m_base != NULL)
+                db_munmap(sp, ep);
+
         /* Update marks, @ and global commands. */
         if (mark_insdel(sp, LINE_DELETE, lno))
                 return (1);
@@ -198,6 +333,7 @@ db_delete(SCR *sp, recno_t lno)
         log_line(sp, lno, LOG_LINE_DELETE);
 
         /* Update file. */
+        ++sp->gp->db_changes;
         key.data = &lno;
         key.size = sizeof(lno);
         if (ep->db->del(ep->db, &key, 0) == 1) {
@@ -211,6 +347,7 @@ db_delete(SCR *sp, recno_t lno)
                 ep->c_lno = OOBLNO;
         if (ep->c_nlines != OOBLNO)
                 --ep->c_nlines;
+        ++ep->c_gen;
 
         /* File now modified. */
         if (F_ISSET(ep, F_FIRSTMODIFY))
@@ -241,7 +378,12 @@ db_append(SCR *sp, int update, recno_t lno, char *p, size_t len)
                 return (1);
         }
 
+        /* The first change switches from the file mapping to the database. */
+        if (ep->m_base != NULL)
+                db_munmap(sp, ep);
+
         /* Update file. */
+        ++sp->gp->db_changes;
         key.data = &lno;
         key.size = sizeof(lno);
         data.data = p;
@@ -257,6 +399,7 @@ db_append(SCR *sp, int update, recno_t lno, char *p, size_t len)
                 ep->c_lno = OOBLNO;
         if (ep->c_nlines != OOBLNO)
                 ++ep->c_nlines;
+        ++ep->c_gen;
 
         /* File now dirty. */
         if (F_ISSET(ep, F_FIRSTMODIFY))
@@ -307,7 +450,12 @@ db_insert(SCR *sp, recno_t lno, char *p, size_t len)
                 return (1);
         }
 
+        /* The first change switches from the file mapping to the database. */
+        if (ep->m_base != NULL)
+                db_munmap(sp, ep);
+
         /* Update file. */
+        ++sp->gp->db_changes;
         key.data = &lno;
         key.size = sizeof(lno);
         data.data = p;
@@ -323,6 +471,7 @@ db_insert(SCR *sp, recno_t lno, char *p, size_t len)
                 ep->c_lno = OOBLNO;
         if (ep->c_nlines != OOBLNO)
                 ++ep->c_nlines;
+        ++ep->c_gen;
 
         /* File now dirty. */
         if (F_ISSET(ep, F_FIRSTMODIFY))
@@ -362,10 +511,15 @@ db_set(SCR *sp, recno_t lno, char *p, size_t len)
                 return (1);
         }
 
+        /* The first change switches from the file mapping to the database. */
+        if (ep->m_base != NULL)
+                db_munmap(sp, ep);
+
         /* Log before change. */
         log_line(sp, lno, LOG_LINE_RESET_B);
 
         /* Update file. */
+        ++sp->gp->db_changes;
         key.data = &lno;
         key.size = sizeof(lno);
         data.data = p;
@@ -376,9 +530,14 @@ db_set(SCR *sp, recno_t lno, char *p, size_t len)
                 return (1);
         }
 
-        /* Flush the cache, before logging or screen update. */
-        if (lno == ep->c_lno)
+        /*
+         * Reload the cache with the new line, before logging or screen
+         * update, so they don't reassemble it from the database; for long
+         * lines that's a copy of every page of the overflow chain.
+         */
+        if (db_cache_update(sp, ep, lno, p, len))
                 ep->c_lno = OOBLNO;
+        ++ep->c_gen;
 
         /* File now dirty. */
         if (F_ISSET(ep, F_FIRSTMODIFY))
@@ -460,6 +619,18 @@ db_last(SCR *sp, recno_t *lnop)
                 return (0);
         }
 
+        /* Count the lines in the file mapping, if there is one. */
+        if (ep->m_base != NULL) {
+                while (!ep->m_eof)
+                        if (db_mextend(ep))
+                                break;
+                if (ep->m_eof) {
+                        lno = ep->c_nlines = ep->m_nlines;
+                        goto done;
+                }
+                db_munmap(sp, ep);
+        }
+
         key.data = &lno;
         key.size = sizeof(lno);
 
@@ -482,12 +653,102 @@ db_last(SCR *sp, recno_t *lnop)
         ep->c_nlines = lno;
 
         /* Return the value. */
-        *lnop = (F_ISSET(sp, SC_TINPUT) &&
+done:   *lnop = (F_ISSET(sp, SC_TINPUT) &&
             TAILQ_LAST(&sp->tiq, _texth)->lno > lno ?
             TAILQ_LAST(&sp->tiq, _texth)->lno : lno);
         return (0);
 }
 
+/*
+ * db_snapshot --
+ *      Finish a snapshot that was put off, by reading the rest of the file
+ *      into the database.
+ *
+ * PUBLIC: int db_snapshot(SCR *);
+ */
+
+int
+db_snapshot(SCR *sp)
+{
+        EXF *ep;
+        recno_t lno;
+
+        ep = sp->ep;
+        F_CLR(ep, F_SNAPSHOT);
+        if (db_last(sp, &lno))
+                return (1);
+        F_CLR(ep, F_READLAZY);
+        return (0);
+}
+
+/*
+ * db_last_est --
+ *      Return the number of lines in the file if it's known, or can be
+ *      found without reading the rest of the file.  Otherwise, return an
+ *      estimate from the part of the file looked at so far, and set *estp.
+ *
+ * PUBLIC: int db_last_est(SCR *, recno_t *, int *);
+ */
+
+int
+db_last_est(SCR *sp, recno_t *lnop, int *estp)
+{
+        struct stat sb;
+        EXF *ep;
+        recno_t cnt;
+        ssize_t nr;
+        size_t blen;
+        int fd;
+        char *bp, *p, *end;
+
+        *estp = 0;
+        if ((ep = sp->ep) == NULL || ep->c_nlines != OOBLNO)
+                return (db_last(sp, lnop));
+
+        /*
+         * The file mapping's index counts the lines in as much of the file
+         * as has been scanned; scale that up to the length of the file.
+         */
+        if (ep->m_base != NULL) {
+                if (ep->m_idxcnt == 1 && !ep->m_eof && db_mextend(ep))
+                        return (db_last(sp, lnop));
+                if (ep->m_eof)
+                        return (db_last(sp, lnop));
+                *lnop = (uintmax_t)(ep->m_idxcnt - 1) * M_STRIDE *
+                    ep->m_len / ep->m_idx[ep->m_idxcnt - 1];
+                goto est;
+        }
+
+        /*
+         * A database reading the file on demand would read all of it to
+         * find the last line.  Estimate from the start of the file instead,
+         * unless the sample is the whole file.
+         */
+        if (ep->c_elines == OOBLNO) {
+                if (!F_ISSET(ep, F_READLAZY) ||
+                    (fd = ep->db->fd(ep->db)) == -1 || fstat(fd, &sb) ||
+                    sb.st_size <= EST_SAMPLE)
+                        return (db_last(sp, lnop));
+                GET_SPACE_RET(sp, bp, blen, EST_SAMPLE);
+                if ((nr = pread(fd, bp, EST_SAMPLE, 0)) <= 0) {
+                        FREE_SPACE(sp, bp, blen);
+                        return (db_last(sp, lnop));
+                }
+                for (cnt = 1, p = bp, end = bp + nr;
+                    (p = memchr(p, '\n', end - p)) != NULL; ++p)
+                        ++cnt;
+                FREE_SPACE(sp, bp, blen);
+                ep->c_elines = (uintmax_t)cnt * sb.st_size / nr;
+        }
+        *lnop = ep->c_elines;
+
+est:    if (F_ISSET(sp, SC_TINPUT) &&
+            TAILQ_LAST(&sp->tiq, _texth)->lno > *lnop)
+                *lnop = TAILQ_LAST(&sp->tiq, _texth)->lno;
+        *estp = 1;
+        return (0);
+}
+
 /*
  * db_err --
  *      Report a line error.
@@ -545,11 +806,411 @@ db_cache_update(SCR *sp, EXF *ep, recno_t lno, void *data, size_t size)
                 }
                 ep->c_buf_len = size;
         }
-        if (size > 0)
-                memcpy(ep->c_buf, data, size);
+        if (size > 0 && data != ep->c_buf)
+                memmove(ep->c_buf, data, size);
 
         ep->c_lno = lno;
         ep->c_len = size;
         ep->c_lp = ep->c_buf;
         return (0);
 }
+
+/*
+ * db_mmap --
+ *      Serve the lines of an unmodified file straight from a read-only
+ *      mapping of it, without copying them into the database.  The lines
+ *      are located through a sparse index of line offsets, built lazily
+ *      as far into the file as anyone has looked.  Returns 0 if the file
+ *      was mapped.
+ *
+ * PUBLIC: int db_mmap(SCR *, EXF *, int);
+ */
+int
+db_mmap(SCR *sp, EXF *ep, int fd)
+{
+        struct sigaction act;
+        struct stat sb;
+        void *p;
+
+        if (fd == -1 || fstat(fd, &sb) || !S_ISREG(sb.st_mode) ||
+            sb.st_size <= 0 || (uintmax_t)sb.st_size > SIZE_MAX)
+                return (1);
+        if (m_list == NULL) {
+                memset(&act, 0, sizeof(act));
+                act.sa_sigaction = db_msigbus;
+                act.sa_flags = SA_SIGINFO;
+                (void)sigemptyset(&act.sa_mask);
+                if ((m_pgsz = sysconf(_SC_PAGESIZE)) <= 0 ||
+                    sigaction(SIGBUS, &act, &m_oact))
+                        return (1);
+        }
+        if ((ep->m_idx = malloc(M_STRIDE * sizeof(size_t))) == NULL)
+                goto err;
+        if ((p = mmap(NULL, (size_t)sb.st_size,
+            PROT_READ, MAP_PRIVATE, fd, 0)) == MAP_FAILED) {
+                free(ep->m_idx);
+                ep->m_idx = NULL;
+                goto err;
+        }
+        ep->m_base = p;
+        ep->m_len = (size_t)sb.st_size;
+        ep->m_idx[0] = 0;
+        ep->m_idxcnt = 1;
+        ep->m_idxlen = M_STRIDE;
+        ep->m_nlines = 0;
+        ep->m_eof = 0;
+        ep->m_clno = OOBLNO;
+        ep->m_cached = 0;
+        ep->m_fault = 0;
+        ep->m_next = m_list;
+        m_list = ep;
+
+        /* An index saved by an earlier session saves scanning the file. */
+        if (O_ISSET(sp, O_LINEINDEX))
+                db_lidx_load(sp, ep);
+        return (0);
+
+err:    if (m_list == NULL)
+                (void)sigaction(SIGBUS, &m_oact, NULL);
+        return (1);
+}
+
+/*
+ * db_munmap --
+ *      Release the file mapping; from now on lines come from the database,
+ *      which reads the file on demand as it always has.
+ *
+ * PUBLIC: void db_munmap(SCR *, EXF *);
+ */
+void
+db_munmap(SCR *sp, EXF *ep)
+{
+        EXF **epp;
+
+        if (ep->m_base == NULL)
+                return;
+
+        /* Save a complete index worth keeping for the next session. */
+        if (ep->m_eof && !ep->m_cached && !db_mfault(ep) &&
+            ep->m_idxcnt >= LIDX_MINIDX && O_ISSET(sp, O_LINEINDEX))
+                db_lidx_save(sp, ep);
+
+        for (epp = &m_list; *epp != ep; epp = &(*epp)->m_next)
+                ;
+        *epp = ep->m_next;
+        if (m_list == NULL)
+                (void)sigaction(SIGBUS, &m_oact, NULL);
+
+        (void)munmap(ep->m_base, ep->m_len);
+        free(ep->m_idx);
+        ep->m_base = NULL;
+        ep->m_idx = NULL;
+        ep->m_idxcnt = ep->m_idxlen = 0;
+
+        /* The line count may not have come from the database. */
+        ep->c_lno = ep->c_nlines = OOBLNO;
+}
+
+/*
+ * db_lidx_open --
+ *      Open the user's line index database; it must be a regular file,
+ *      owned by and only accessible to the user.  The lock keeps other
+ *      sessions out while it's open.  It's only created to save into.
+ */
+static DB *
+db_lidx_open(SCR *sp, int create)
+{
+        struct stat sb;
+        DB *db;
+        int fd;
+        char path[PATH_MAX];
+
+        if (opts_empty(sp, O_RECDIR, 1))
+                return (NULL);
+        (void)snprintf(path, sizeof(path), "%s/lineidx.%lu",
+            O_STR(sp, O_RECDIR), (unsigned long)getuid());
+        if ((db = dbopen(path,
+            (create ? O_CREAT : 0) | O_NOFOLLOW | O_RDWR,
+            S_IRUSR | S_IWUSR, DB_HASH, NULL)) == NULL)
+                return (NULL);
+        if ((fd = db->fd(db)) == -1 || fstat(fd, &sb) ||
+            !S_ISREG(sb.st_mode) || sb.st_uid != getuid() ||
+            sb.st_mode & (S_IRWXG | S_IRWXO) || flock(fd, LOCK_EX | LOCK_NB)) {
+                (void)db->close(db);
+                return (NULL);
+        }
+        return (db);
+}
+
+/*
+ * db_lidx_key --
+ *      Build the line index database key for a file.
+ */
+static void
+db_lidx_key(EXF *ep, LIDX_KEY *kp)
+{
+        memset(kp, 0, sizeof(*kp));
+        kp->dev = ep->mdev;
+        kp->ino = ep->minode;
+        kp->size = ep->m_len;
+        kp->sec = ep->mtim.tv_sec;
+        kp->nsec = ep->mtim.tv_nsec;
+}
+
+/*
+ * db_lidx_load --
+ *      Replace the mapped file's line index with a saved one, if there is
+ *      one that is sane.
+ */
+static void
+db_lidx_load(SCR *sp, EXF *ep)
+{
+        DB *db;
+        DBT data, key;
+        LIDX_HDR h;
+        LIDX_KEY k;
+        size_t cnt, *idx;
+
+        if ((db = db_lidx_open(sp, 0)) == NULL)
+                return;
+        db_lidx_key(ep, &k);
+        key.data = &k;
+        key.size = sizeof(k);
+        if (db->get(db, &key, &data, 0) || data.size < sizeof(h))
+                goto done;
+        memcpy(&h, data.data, sizeof(h));
+        if (h.magic != LIDX_MAGIC || h.stride != M_STRIDE ||
+            h.offsize != sizeof(size_t) || h.nlines == 0 ||
+            h.idxcnt != (h.nlines - 1) / M_STRIDE + 1 ||
+            data.size != sizeof(h) + h.idxcnt * sizeof(size_t))
+                goto done;
+        if ((idx = malloc(h.idxcnt * sizeof(size_t))) == NULL)
+                goto done;
+        memcpy(idx, (char *)data.data + sizeof(h), h.idxcnt * sizeof(size_t));
+
+        /*
+         * The offsets must be in the file, in order, and at the start of
+         * a line.
+         */
+        for (cnt = 0; cnt < h.idxcnt; ++cnt)
+                if (idx[cnt] >= ep->m_len ||
+                    (cnt == 0 ? idx[cnt] != 0 : idx[cnt] <= idx[cnt - 1]) ||
+                    (idx[cnt] != 0 && ep->m_base[idx[cnt] - 1] != '\n'))
+                        break;
+        if (cnt != h.idxcnt) {
+                free(idx);
+                goto done;
+        }
+
+        free(ep->m_idx);
+        ep->m_idx = idx;
+        ep->m_idxcnt = ep->m_idxlen = h.idxcnt;
+        ep->m_nlines = h.nlines;
+        ep->m_eof = ep->m_cached = 1;
+done:   (void)db->close(db);
+}
+
+/*
+ * db_lidx_save --
+ *      Save the mapped file's complete line index.
+ */
+static void
+db_lidx_save(SCR *sp, EXF *ep)
+{
+        DB *db;
+        DBT data, key, okey;
+        LIDX_HDR h;
+        LIDX_KEY k, ok;
+        time_t ostamp;
+        unsigned int nent;
+        char *bp;
+
+        if ((db = db_lidx_open(sp, 1)) == NULL)
+                return;
+        memset(&h, 0, sizeof(h));
+        h.magic = LIDX_MAGIC;
+        h.stride = M_STRIDE;
+        h.offsize = sizeof(size_t);
+        h.nlines = ep->m_nlines;
+        h.idxcnt = ep->m_idxcnt;
+        h.stamp = time(NULL);
+        data.size = sizeof(h) + ep->m_idxcnt * sizeof(size_t);
+        if ((bp = data.data = malloc(data.size)) == NULL)
+                goto done;
+        memcpy(bp, &h, sizeof(h));
+        memcpy(bp + sizeof(h), ep->m_idx, ep->m_idxcnt * sizeof(size_t));
+        db_lidx_key(ep, &k);
+        key.data = &k;
+        key.size = sizeof(k);
+        (void)db->put(db, &key, &data, 0);
+        free(bp);
+
+        /* Forget the oldest file if there are too many. */
+        nent = 0;
+        ostamp = 0;
+        for (okey.size = 0;
+            db->seq(db, &key, &data, nent == 0 ? R_FIRST : R_NEXT) == 0;) {
+                ++nent;
+                if (key.size != sizeof(ok) || data.size < sizeof(h))
+                        continue;
+                memcpy(&h, data.data, sizeof(h));
+                if (okey.size == 0 || h.stamp < ostamp) {
+                        memcpy(&ok, key.data, sizeof(ok));
+                        okey.data = &ok;
+                        okey.size = sizeof(ok);
+                        ostamp = h.stamp;
+                }
+        }
+        if (nent > LIDX_MAXENT && okey.size != 0)
+                (void)db->del(db, &okey, 0);
+done:   (void)db->close(db);
+}
+
+/*
+ * db_mextend --
+ *      Extend the file mapping's line index by one entry, or find the end
+ *      of the file.  The scan is a memchr(3) per line, which the C library
+ *      generally vectorizes.
+ */
+static int
+db_mextend(EXF *ep)
+{
+        recno_t cnt;
+        size_t *t;
+        char *p, *end;
+
+        if (db_mfault(ep))
+                return (1);
+        p = ep->m_base + ep->m_idx[ep->m_idxcnt - 1];
+        end = ep->m_base + ep->m_len;
+        for (cnt = 0; cnt < M_STRIDE && p < end; ++cnt)
+                if ((p = memchr(p, '\n', end - p)) == NULL)
+                        p = end;
+                else
+                        ++p;
+        if (db_mfault(ep))
+                return (1);
+        if (p >= end) {
+                ep->m_nlines = (ep->m_idxcnt - 1) * M_STRIDE + cnt;
+                ep->m_eof = 1;
+                return (0);
+        }
+
+        if (ep->m_idxcnt == ep->m_idxlen) {
+                if ((t = openbsd_reallocarray(ep->m_idx,
+                    ep->m_idxlen * 2, sizeof(size_t))) == NULL)
+                        return (1);
+                ep->m_idx = t;
+                ep->m_idxlen *= 2;
+        }
+        ep->m_idx[ep->m_idxcnt++] = p - ep->m_base;
+        return (0);
+}
+
+/*
+ * db_mget --
+ *      Find a line in the file mapping.  Returns 1 if the line doesn't
+ *      exist, and -1 if the index couldn't be extended.
+ */
+static int
+db_mget(EXF *ep, recno_t lno, char **pp, size_t *lenp)
+{
+        recno_t cur;
+        size_t entry, off;
+        char *p;
+
+        if (db_mfault(ep))
+                return (-1);
+        entry = (lno - 1) / M_STRIDE;
+        while (ep->m_idxcnt <= entry && !ep->m_eof)
+                if (db_mextend(ep))
+                        return (-1);
+        if (ep->m_idxcnt <= entry || (ep->m_eof && lno > ep->m_nlines))
+                return (1);
+
+        /*
+         * Start at the index entry, or at the last line looked up if that
+         * is closer; screen painting walks the lines in order.
+         */
+        if (ep->m_clno != OOBLNO && ep->m_clno <= lno &&
+            (ep->m_clno - 1) / M_STRIDE == entry) {
+                cur = ep->m_clno;
+                off = ep->m_coff;
+        } else {
+                cur = entry * M_STRIDE + 1;
+                off = ep->m_idx[entry];
+        }
+        for (; cur < lno; ++cur) {
+                if ((p = memchr(ep->m_base + off,
+                    '\n', ep->m_len - off)) == NULL)
+                        return (1);
+                if ((off = p - ep->m_base + 1) >= ep->m_len)
+                        return (1);
+        }
+        ep->m_clno = lno;
+        ep->m_coff = off;
+
+        *pp = ep->m_base + off;
+        p = memchr(*pp, '\n', ep->m_len - off);
+        *lenp = p == NULL ? ep->m_len - off : (size_t)(p - *pp);
+        return (db_mfault(ep) ? -1 : 0);
+}
+
+/*
+ * db_mfault --
+ *      Return 1 if the file mapping can't be trusted, because SIGBUS was
+ *      raised touching it.  The file sizes are only checked after a fault.
+ */
+static int
+db_mfault(EXF *ep)
+{
+        EXF *mep;
+
+        if (m_sigbus) {
+                m_sigbus = 0;
+                for (mep = m_list; mep != NULL; mep = mep->m_next)
+                        if (db_mshrunk(mep))
+                                mep->m_fault = 1;
+        }
+        return (ep->m_fault);
+}
+
+/*
+ * db_mshrunk --
+ *      Return 1 if the mapped file is shorter than when it was mapped.
+ */
+static int
+db_mshrunk(EXF *ep)
+{
+        struct stat sb;
+        int fd;
+
+        return ((fd = ep->db->fd(ep->db)) == -1 || fstat(fd, &sb) ||
+            sb.st_size < 0 || (uintmax_t)sb.st_size < ep->m_len);
+}
+
+/*
+ * db_msigbus --
+ *      SIGBUS handler: if the fault is in a file mapping, replace the page
+ *      with one of zeroes and return to retry the access.  Otherwise, put
+ *      back the previous action, which the retried access then gets.
+ */
+static void
+db_msigbus(int signo, siginfo_t *info, void *ctx)
+{
+        EXF *ep;
+        char *pg;
+        int sverrno;
+
+        sverrno = errno;
+        pg = (char *)info->si_addr - (uintptr_t)info->si_addr % m_pgsz;
+        for (ep = m_list; ep != NULL; ep = ep->m_next)
+                if (pg >= ep->m_base && pg < ep->m_base + ep->m_len)
+                        break;
+        if (ep != NULL && mmap(pg, (size_t)m_pgsz, PROT_READ,
+            MAP_PRIVATE | MAP_ANON | MAP_FIXED, -1, 0) != MAP_FAILED)
+                m_sigbus = 1;
+        else
+                (void)sigaction(SIGBUS, &m_oact, NULL);
+        errno = sverrno;
+}
@@ -41,6 +41,7 @@
 static void      attach(GS *);
 #endif /* ifdef DEBUG */
 static int       v_obsolete(char *[]);
+static void      v_phase_dump(GS *);
 
 enum pmode pmode;
 
@@ -103,6 +104,7 @@ editor(GS *gp, int argc, char *argv[])
         TAILQ_INIT(&gp->dcb_store.textq);
         LIST_INIT(&gp->cutq);
         LIST_INIT(&gp->seqq);
+        TAILQ_INIT(&gp->rech);
 
         /* Set initial screen type and mode based on the program name. */
         readonly = 0;
@@ -138,6 +140,10 @@ editor(GS *gp, int argc, char *argv[])
         /* Set the file snapshot flag. */
         F_SET(gp, G_SNAPSHOT);
 
+        /* Keep counters for an exit dump if VISTATS is set. */
+        if (getenv("VISTATS") != NULL)
+                F_SET(gp, G_STATS);
+
         pmode = MODE_EX;
         if (!strcmp(bsd_getprogname(), "ex")   ||
             !strcmp(bsd_getprogname(), "nex")  ||
@@ -307,6 +313,7 @@ editor(GS *gp, int argc, char *argv[])
 
         if (v_key_init(sp))             /* Special key initialization. */
                 goto err;
+        v_phase(gp, "screen");
 
         { int oargs[5], *oargp = oargs;
         if (readonly)                   /* Command-line options. */
@@ -338,6 +345,7 @@ editor(GS *gp, int argc, char *argv[])
 
         sp->rows = O_VAL(sp, O_LINES);  /* Make ex formatting work. */
         sp->cols = O_VAL(sp, O_COLUMNS);
+        v_phase(gp, "options");
 
         if (!silent && startup) {       /* Read EXINIT, exrc files. */
                 if (ex_exrc(sp))
@@ -348,6 +356,7 @@ editor(GS *gp, int argc, char *argv[])
                         goto done;
                 }
         }
+        v_phase(gp, "exrc");
 
         /*
          * List recovery files if -r specified without file arguments.
@@ -448,6 +457,12 @@ editor(GS *gp, int argc, char *argv[])
                 }
         }
 
+        v_phase(gp, "file");
+
+        /* Ex is started; vi is once it paints the first screen. */
+        if (!LF_ISSET(SC_VI))
+                F_CLR(gp, G_STARTUP);
+
         /*
          * Check to see if we need to wait for ex.  If SC_SCR_EX is set, ex
          * was forced to initialize the screen during startup.  We'd like to
@@ -518,6 +533,10 @@ v_end(GS *gp)
         while ((sp = TAILQ_FIRST(&gp->hq)))
                 (void)screen_end(sp);   /* Removes sp from the queue. */
 
+        /* Write the counters, now that the files are closed. */
+        stats_dump(gp);
+        v_phase_dump(gp);
+
 #if defined(DEBUG) || defined(PURIFY)
         { FREF *frp;
                 /* Free FREF's. */
@@ -538,6 +557,9 @@ v_end(GS *gp)
         /* Free map sequences. */
         seq_close(gp);
 
+        /* Free compiled REs. */
+        re_cache_end(gp);
+
         /* Free default buffer storage. */
         (void)text_lfree(&gp->dcb_store.textq);
 #endif /* if defined(DEBUG) || defined(PURIFY) */
@@ -575,6 +597,52 @@ v_end(GS *gp)
 #endif /* if defined(DEBUG) || defined(PURIFY) */
 }
 
+/*
+ * v_phase --
+ *      Mark the end of a startup phase, if VISTARTUP is set.  The first
+ *      mark is the start of the first phase.
+ *
+ * PUBLIC: void v_phase(GS *, const char *);
+ */
+
+void
+v_phase(GS *gp, const char *name)
+{
+        if (!F_ISSET(gp, G_STARTUP) || gp->nphases == MAX_PHASES)
+                return;
+        gp->phases[gp->nphases].name = name;
+        gp->phases[gp->nphases++].nsec = nsec_now();
+}
+
+/*
+ * v_phase_dump --
+ *      Write the time taken by each startup phase: to the file VISTARTUP
+ *      names, or if it's empty, to the standard error output.
+ */
+
+static void
+v_phase_dump(GS *gp)
+{
+        FILE *fp;
+        int i;
+        char *p;
+
+        if (gp->nphases < 2 || (p = getenv("VISTARTUP")) == NULL)
+                return;
+        if (*p == '\0')
+                fp = stderr;
+        else if ((fp = fopen(p, "a")) == NULL)
+                return;
+        for (i = 1; i < gp->nphases; ++i)
+                (void)fprintf(fp, "startup: %-10s %10.3f ms\n",
+                    gp->phases[i].name,
+                    (gp->phases[i].nsec - gp->phases[i - 1].nsec) / 1e6);
+        (void)fprintf(fp, "startup: %-10s %10.3f ms\n", "total",
+            (gp->phases[gp->nphases - 1].nsec - gp->phases[0].nsec) / 1e6);
+        if (fp != stderr)
+                (void)fclose(fp);
+}
+
 /*
  * v_obsolete --
  *      Convert historic arguments into something
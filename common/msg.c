@@ -360,7 +360,7 @@ msgq_status(SCR *sp, recno_t lno, unsigned int flags)
 {
         recno_t last;
         size_t blen, len;
-        int cnt, needsep;
+        int cnt, est, needsep;
         const char *t;
         char **ap, *bp, *np, *p, *s, *ep;
 
@@ -453,14 +453,25 @@ msgq_status(SCR *sp, recno_t lno, unsigned int flags)
                 *p++ = ':';
                 *p++ = ' ';
         }
+        /*
+         * Don't read the rest of a large file just to count its lines; if
+         * they haven't been counted yet, report an estimate.
+         */
+        if (db_last_est(sp, &last, &est))
+                last = 0;
+        if (est && last < lno)
+                last = lno;
         if (LF_ISSET(MSTAT_SHOWLAST)) {
-                if (db_last(sp, &last))
-                        last = 0;
                 if (last == 0) {
                         char* mtfilestr = "empty file";
                         len = strlen(mtfilestr);
                         memcpy(p, mtfilestr, len);
                         p += len;
+                } else if (est) {
+                        (void)snprintf(p, ep - p,
+                            "line %'lu of ~%'lu (estimating)",
+                            (unsigned long)lno, (unsigned long)last);
+                        p += strlen(p);
                 } else {
                         (void)snprintf(p, ep - p, "line %'lu of %'lu [%lu%%]",
                             (unsigned long)lno, (unsigned long)last,
@@ -468,12 +479,11 @@ msgq_status(SCR *sp, recno_t lno, unsigned int flags)
                         p += strlen(p);
                 }
         } else {
-                if (db_last(sp, &last))
-                        last = 0;
                 (void)snprintf(p, ep - p, "line %'lu", (unsigned long)lno);
                 p += strlen(p);
                 if (last) {
-                        (void)snprintf(p, ep - p, " of %'lu", (unsigned long)last);
+                        (void)snprintf(p, ep - p, est ? " of ~%'lu" : " of %'lu",
+                            (unsigned long)last);
                         p += strlen(p);
                 }
         }
@@ -67,6 +67,8 @@ OPTLIST const optlist[] = {
         {"backup",      NULL,           OPT_STR,        0},
 /* O_BEAUTIFY       4BSD */
         {"beautify",    NULL,           OPT_0BOOL,      0},
+/* O_BRACKETPASTE OpenVi */
+        {"bracketpaste", NULL,          OPT_1BOOL,      0},
 /* O_BSERASE      OpenVi */
         {"bserase",     NULL,           OPT_0BOOL,      0},
 /* O_CWERASE      OpenVi */
@@ -111,6 +113,8 @@ OPTLIST const optlist[] = {
         {"leftright",   f_reformat,     OPT_0BOOL,      0},
 /* O_LINES        4.4BSD */
         {"lines",       f_lines,        OPT_NUM,        OPT_NOSAVE},
+/* O_LINEINDEX    OpenVi */
+        {"lineindex",   NULL,           OPT_1BOOL,      0},
 /* O_LIST           4BSD */
         {"list",        f_reformat,     OPT_0BOOL,      0},
 /* O_LOCKFILES    4.4BSD */
@@ -213,6 +217,8 @@ OPTLIST const optlist[] = {
         {"wrapscan",    NULL,           OPT_1BOOL,      0},
 /* O_WRITEANY       4BSD */
         {"writeany",    NULL,           OPT_0BOOL,      0},
+/* O_ZCACHE       OpenVi */
+        {"zcache",      NULL,           OPT_NUM,        0},
         {NULL,          NULL,           255,            0},
 };
 
@@ -0,0 +1,84 @@
+enum {
+	O_ALTNOTATION = 0,
+	O_ALTWERASE,
+	O_AUTOINDENT,
+	O_AUTOPRINT,
+	O_AUTOWRITE,
+	O_BACKUP,
+	O_BEAUTIFY,
+	O_BRACKETPASTE,
+	O_BSERASE,
+	O_CWERASE,
+	O_CDPATH,
+	O_CEDIT,
+	O_COLUMNS,
+	O_COMMENT,
+	O_EDCOMPATIBLE,
+	O_ESCAPETIME,
+	O_ERRORBELLS,
+	O_EXPANDTAB,
+	O_EXRC,
+	O_EXTENDED,
+	O_FILEC,
+	O_FLASH,
+	O_HARDTABS,
+	O_ICLOWER,
+	O_IGNORECASE,
+	O_IMCTRL,
+	O_IMKEY,
+	O_KEYTIME,
+	O_LEFTRIGHT,
+	O_LINES,
+	O_LINEINDEX,
+	O_LIST,
+	O_LOCKFILES,
+	O_MAGIC,
+	O_MATCHTIME,
+	O_MESG,
+	O_NOPRINT,
+	O_NUMBER,
+	O_OCTAL,
+	O_OPEN,
+	O_PARAGRAPHS,
+	O_PATH,
+	O_PRINT,
+	O_PROMPT,
+	O_READONLY,
+	O_RECDIR,
+	O_REMAP,
+	O_REPORT,
+	O_RULER,
+	O_SCROLL,
+	O_SEARCHINCR,
+	O_SECTIONS,
+	O_SECURE,
+	O_SHELL,
+	O_SHELLMETA,
+	O_SHIFTWIDTH,
+	O_SHOWMATCH,
+	O_SHOWFILENAME,
+	O_SHOWMODE,
+	O_SIDESCROLL,
+	O_TABSTOP,
+	O_TAGLENGTH,
+	O_TAGS,
+	O_TERM,
+	O_TERSE,
+	O_TILDEOP,
+	O_TIMEOUT,
+	O_TTYWERASE,
+	O_VERBOSE,
+	O_VISIBLETAB,
+	O_W1200,
+	O_W300,
+	O_W9600,
+	O_WARN,
+	O_WINDOW,
+	O_WINDOWNAME,
+	O_WRAPLEN,
+	O_WRAPMARGIN,
+	O_WRAPSCAN,
+	O_WRITEANY,
+	O_ZCACHE,
+	O_OPTIONCOUNT
+};
@@ -187,11 +187,11 @@ int
 f_recompile(SCR *sp, OPTION *op, char *str, unsigned long *valp)
 {
         if (F_ISSET(sp, SC_RE_SEARCH)) {
-                regfree(&sp->re_c);
+                re_release(sp, &sp->re_c);
                 F_CLR(sp, SC_RE_SEARCH);
         }
         if (F_ISSET(sp, SC_RE_SUBST)) {
-                regfree(&sp->subre_c);
+                re_release(sp, &sp->subre_c);
                 F_CLR(sp, SC_RE_SUBST);
         }
         return (0);
@@ -265,6 +265,8 @@ int
 rcv_sync(SCR *sp, unsigned int flags)
 {
         EXF *ep;
+        GS *gp;
+        unsigned long long ns;
         int fd, rval;
         char *dp, buf[1024];
 
@@ -277,7 +279,14 @@ rcv_sync(SCR *sp, unsigned int flags)
         if (F_ISSET(ep, F_MODIFIED)) {
                 /* Clear recovery sync flag. */
                 F_CLR(ep, F_RCV_SYNC);
-                if (ep->db->sync(ep->db, R_RECNOSYNC)) {
+                gp = sp->gp;
+                ns = nsec_now();
+                rval = ep->db->sync(ep->db, R_RECNOSYNC);
+                ns = nsec_now() - ns;
+                ++gp->rcv_syncs;
+                if (ns > gp->rcv_nsec)
+                        gp->rcv_nsec = ns;
+                if (rval) {
                         F_CLR(ep, F_RCV_ON | F_RCV_NORM);
                         msgq_str(sp, M_SYSERR,
                             ep->rcv_path, "File backup failed: %s");
@@ -185,10 +185,10 @@ screen_end(SCR *sp)
         /* Free up search information. */
         free(sp->re);
         if (F_ISSET(sp, SC_RE_SEARCH))
-                regfree(&sp->re_c);
+                re_release(sp, &sp->re_c);
         free(sp->subre);
         if (F_ISSET(sp, SC_RE_SUBST))
-                regfree(&sp->subre_c);
+                re_release(sp, &sp->subre_c);
         free(sp->repl);
         free(sp->newl);
 
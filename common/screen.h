@@ -78,6 +78,7 @@ struct _scr {
         recno_t  rptlines[L_YANKED + 1];/* Ex/vi: lines changed by last op. */
 
         TEXTH    tiq;                   /* Ex/vi: text input queue. */
+        TEXT    *tilast;                /* Vi: last tiq TEXT db_get() found. */
 
         SCRIPT  *script;                /* Vi: script mode information .*/
 
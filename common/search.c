@@ -236,7 +236,7 @@ f_search(SCR *sp, MARK *fm, MARK *rm, char *ptrn, size_t plen, char **eptrn,
                 match[0].rm_eo = len;
 
                 /* Search the line. */
-                eval = regexec(&sp->re_c, l, 1, match,
+                eval = re_exec(sp, &sp->re_c, l, 1, match,
                     (match[0].rm_so == 0 ? 0 : REG_NOTBOL) | REG_STARTEND);
                 if (eval == REG_NOMATCH)
                         continue;
@@ -364,7 +364,7 @@ b_search(SCR *sp, MARK *fm, MARK *rm, char *ptrn, size_t plen, char **eptrn,
                 match[0].rm_eo = len;
 
                 /* Search the line. */
-                eval = regexec(&sp->re_c, l, 1, match,
+                eval = re_exec(sp, &sp->re_c, l, 1, match,
                     (match[0].rm_eo == len ? 0 : REG_NOTEOL) | REG_STARTEND);
                 if (eval == REG_NOMATCH)
                         continue;
@@ -396,7 +396,7 @@ b_search(SCR *sp, MARK *fm, MARK *rm, char *ptrn, size_t plen, char **eptrn,
                         if (match[0].rm_so >= len)
                                 break;
                         match[0].rm_eo = len;
-                        eval = regexec(&sp->re_c, l, 1, match,
+                        eval = re_exec(sp, &sp->re_c, l, 1, match,
                             (match[0].rm_so == 0 ? 0 : REG_NOTBOL) |
                             REG_STARTEND);
                         if (eval == REG_NOMATCH)
@@ -19,6 +19,7 @@
 #include <errno.h>
 #include <limits.h>
 #include <stdio.h>
+#include <time.h>
 #include <bsd_stdlib.h>
 #include <bsd_string.h>
 #include <bsd_unistd.h>
@@ -159,6 +160,22 @@ nget_slong(long *valp, const char *p, char **endp, int base)
         return (NUM_ERR);
 }
 
+/*
+ * nsec_now --
+ *      Return the monotonic clock, in nanoseconds.
+ *
+ * PUBLIC: unsigned long long nsec_now(void);
+ */
+
+unsigned long long
+nsec_now(void)
+{
+        struct timespec ts;
+
+        (void)clock_gettime(CLOCK_MONOTONIC, &ts);
+        return ((unsigned long long)ts.tv_sec * 1000000000 + ts.tv_nsec);
+}
+
 #ifdef DEBUG
 # include <stdarg.h>
 
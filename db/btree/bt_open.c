@@ -168,6 +168,7 @@ __bt_open(const char *fname, int flags, int mode, const BTREEINFO *openinfo,
                 b.minkeypage = DEFMINKEYPAGE;
                 b.prefix = __bt_defpfx;
                 b.psize = 0;
+                b.zcachesize = 0;
         }
 
         /* Check for the ubiquitous PDP-11. */
@@ -325,6 +326,9 @@ __bt_open(const char *fname, int flags, int mode, const BTREEINFO *openinfo,
                 goto err;
         if (!F_ISSET(t, B_INMEM))
                 mpool_filter(t->bt_mp, __bt_pgin, __bt_pgout, t);
+        if (b.zcachesize &&
+            mpool_zcache(t->bt_mp, b.zcachesize) == RET_ERROR)
+                goto err;
 
         /* Create a root page if new tree. */
         if (nroot(t) == RET_ERROR)
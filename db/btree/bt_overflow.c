@@ -51,6 +51,7 @@
 #include "btree.h"
 
 #define MINIMUM(a, b)   (((a) < (b)) ? (a) : (b))
+#define OVFL_PINMAX     256             /* Most pages rewritten in place. */
 
 /*
  * Big key/data code.
@@ -182,6 +183,142 @@ __ovfl_put(BTREE *t, const DBT *dbt, pgno_t *pg)
         return (RET_SUCCESS);
 }
 
+/*
+ * __OVFL_UPDATE -- Replace an overflow item in place.
+ *
+ * Parameters:
+ *      t:      tree
+ *      p:      pointer to { pgno_t, u_int32_t }
+ *      data:   DBT to store
+ *
+ * Returns:
+ *      RET_ERROR, RET_SUCCESS
+ *
+ * The new record is written over the existing chain rather than into a
+ * fresh one, so that a small edit to a very long record only dirties the
+ * pages whose contents actually change.  The chain is extended or freed
+ * at its tail as the record grows or shrinks, and the reference at p is
+ * updated; the caller must dirty the page holding it.  On error, the old
+ * record is left as it was.  The chain must not be one shared with an
+ * internal page, which is never the case for recno trees.
+ */
+
+int
+__ovfl_update(BTREE *t, void *p, const DBT *dbt)
+{
+        struct {
+                PAGE *h;                /* Pinned page. */
+                size_t off;             /* Offset of its data in the record. */
+                unsigned int dirty;     /* If its data changes. */
+        } *pin;
+        DBT tdbt;
+        PAGE *h;
+        pgno_t pg, npg, tpg;
+        size_t cnt, i, nb, off, plen;
+        u_int32_t osz, sz;
+        unsigned int dirty;
+
+        memmove(&pg, p, sizeof(pgno_t));
+        memmove(&osz, (char *)p + sizeof(pgno_t), sizeof(u_int32_t));
+
+#ifdef DEBUG
+        if (pg == P_INVALID || osz == 0 || dbt->size == 0)
+                abort();
+#endif /* ifdef DEBUG */
+
+        if ((pin = malloc(OVFL_PINMAX * sizeof(*pin))) == NULL)
+                return (RET_ERROR);
+
+        /*
+         * Step through the existing chain until either it or the new data
+         * runs out, keeping the pages whose contents differ, and the last
+         * page, whose link may change, pinned.  Nothing is written until
+         * everything that can fail has been done, so that an error leaves
+         * the old record whole.  If too many pages change to keep them all
+         * pinned, e.g., after an insert near the start of the record, copy
+         * it into a new chain instead, as that rewrites every page anyway.
+         */
+        plen = t->bt_psize - BTDATAOFF;
+        for (cnt = off = 0, sz = dbt->size;; off += nb, pg = h->nextpg) {
+                if ((h = mpool_get(t->bt_mp, pg, 0)) == NULL)
+                        goto err;
+                nb = MINIMUM(sz, plen);
+                sz -= nb;
+                dirty = memcmp((char *)h + BTDATAOFF,
+                    (char *)dbt->data + off, nb) != 0 ? MPOOL_DIRTY : 0;
+                if (osz <= plen || sz == 0 || dirty) {
+                        if (cnt == OVFL_PINMAX) {
+                                mpool_put(t->bt_mp, h, 0);
+                                goto copy;
+                        }
+                        pin[cnt].h = h;
+                        pin[cnt].off = off;
+                        pin[cnt++].dirty = dirty;
+                } else
+                        mpool_put(t->bt_mp, h, 0);
+                if (osz <= plen || sz == 0)
+                        break;
+                osz -= plen;
+        }
+        tpg = h->nextpg;
+        off += nb;
+
+        /* The new data is longer: copy the rest of it into a new chain. */
+        npg = P_INVALID;
+        if (sz != 0) {
+                tdbt.data = (char *)dbt->data + off;
+                tdbt.size = sz;
+                if (__ovfl_put(t, &tdbt, &npg) == RET_ERROR)
+                        goto err;
+        }
+
+        /* Overwrite the pages that change, and link any new chain. */
+        for (i = 0; i < cnt; ++i) {
+                h = pin[i].h;
+                if (pin[i].dirty)
+                        memmove((char *)h + BTDATAOFF, (char *)dbt->data +
+                            pin[i].off, MINIMUM(dbt->size - pin[i].off, plen));
+                if (i == cnt - 1 && h->nextpg != npg) {
+                        h->nextpg = npg;
+                        pin[i].dirty = MPOOL_DIRTY;
+                }
+                mpool_put(t->bt_mp, h, pin[i].dirty);
+        }
+        free(pin);
+        memmove((char *)p + sizeof(pgno_t), &dbt->size, sizeof(u_int32_t));
+
+        /*
+         * The new data is shorter: free the old chain's tail.  The record is
+         * already complete, so a page that can't be read is lost rather than
+         * failing the store.
+         */
+        if (sz == 0 && osz > plen)
+                for (osz -= plen;; osz -= plen) {
+                        if ((h = mpool_get(t->bt_mp, tpg, 0)) == NULL)
+                                break;
+                        tpg = h->nextpg;
+                        (void)__bt_free(t, h);
+                        if (osz <= plen)
+                                break;
+                }
+        return (RET_SUCCESS);
+
+copy:   while (cnt > 0)
+                mpool_put(t->bt_mp, pin[--cnt].h, 0);
+        free(pin);
+        if (__ovfl_put(t, dbt, &npg) == RET_ERROR)
+                return (RET_ERROR);
+        (void)__ovfl_delete(t, p);
+        memmove(p, &npg, sizeof(pgno_t));
+        memmove((char *)p + sizeof(pgno_t), &dbt->size, sizeof(u_int32_t));
+        return (RET_SUCCESS);
+
+err:    while (cnt > 0)
+                mpool_put(t->bt_mp, pin[--cnt].h, 0);
+        free(pin);
+        return (RET_ERROR);
+}
+
 /*
  * __OVFL_DELETE -- Delete an overflow chain.
  *
@@ -364,6 +364,8 @@ typedef struct _btree {
         size_t    bt_msize;             /* R: size of mapped region. */
 
         recno_t   bt_nrecs;             /* R: number of records */
+        pgno_t    bt_rdpgno;            /* R: leaf page of the last read */
+        recno_t   bt_rdbase;            /* R: its first record */
         size_t    bt_reclen;            /* R: fixed record length */
         unsigned char    bt_bval;       /* R: delimiting byte/pad character */
 
@@ -64,6 +64,7 @@ int      __bt_sync(const DB *, unsigned int);
 int      __ovfl_delete(BTREE *, void *);
 int      __ovfl_get(BTREE *, void *, size_t *, void **, size_t *);
 int      __ovfl_put(BTREE *, const DBT *, pgno_t *);
+int      __ovfl_update(BTREE *, void *, const DBT *);
 
 #ifdef DEBUG
 void     __bt_dnpage(DB *, pgno_t);
@@ -51,6 +51,7 @@
 
 #include <bsd_db.h>
 #include <compat_bsd_db.h>
+#include "../btree/btree.h"
 
 #undef open
 
@@ -84,6 +85,41 @@ dbopen(const char *fname, int flags, int mode, DBTYPE type,
 }
 DEF_WEAK(dbopen);
 
+/*
+ * DBSTAT -- Return the buffer pool counters of a btree or recno database.
+ *
+ * Parameters:
+ *      dbp:    pointer to the DB structure.
+ *      st:     the counters.
+ *
+ * Returns:
+ *      RET_ERROR, RET_SUCCESS
+ */
+
+int
+dbstat(const DB *dbp, DBSTAT *st)
+{
+        MPOOL *mp;
+
+        switch (dbp->type) {
+        case DB_BTREE:
+        case DB_RECNO:
+                mp = ((BTREE *)dbp->internal)->bt_mp;
+                st->cachehit = mp->cachehit;
+                st->cachemiss = mp->cachemiss;
+                st->pageread = mp->pageread;
+                st->pagewrite = mp->pagewrite;
+                st->zhit = mp->zhit;
+                st->zstore = mp->zstore;
+                return (RET_SUCCESS);
+        default:
+                break;
+        }
+        errno = EINVAL;
+        return (RET_ERROR);
+}
+DEF_WEAK(dbstat);
+
 static int
 __dberr(void)
 {
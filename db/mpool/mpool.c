@@ -43,6 +43,7 @@
 #include <sys/stat.h>
 
 #include <errno.h>
+#include <stddef.h>
 #include <stdio.h>
 #include <bsd_stdlib.h>
 #include <bsd_string.h>
@@ -59,6 +60,15 @@
 static BKT *mpool_bkt(MPOOL *);
 static BKT *mpool_look(MPOOL *, pgno_t);
 static int  mpool_write(MPOOL *, BKT *);
+static int  mpool_pwrite(MPOOL *, pgno_t, void *);
+static int  mpool_zput(MPOOL *, BKT *);
+static int  mpool_zget(MPOOL *, pgno_t, void *);
+static int  mpool_zdrop(MPOOL *, ZBKT *, int);
+static ZBKT *mpool_zlook(MPOOL *, pgno_t);
+static size_t mpool_lzcomp(const unsigned char *, size_t,
+    unsigned char *, size_t);
+static int  mpool_lzdecomp(const unsigned char *, size_t,
+    unsigned char *, size_t);
 
 /*
  * mpool_open --
@@ -90,8 +100,11 @@ mpool_open(void *key, int fd, pgno_t pagesize, pgno_t maxcache)
         if ((mp = (MPOOL *)calloc(1, sizeof(MPOOL))) == NULL)
                 return (NULL);
         TAILQ_INIT(&mp->lqh);
-        for (entry = 0; entry < HASHSIZE; ++entry)
+        TAILQ_INIT(&mp->zlqh);
+        for (entry = 0; entry < HASHSIZE; ++entry) {
                 TAILQ_INIT(&mp->hqh[entry]);
+                TAILQ_INIT(&mp->zhqh[entry]);
+        }
         mp->maxcache = maxcache;
         mp->npages   = sb.st_size / pagesize;
         mp->pagesize = pagesize;
@@ -113,6 +126,33 @@ mpool_filter(MPOOL *mp, void (*pgin) (void *, pgno_t, void *),
         mp->pgcookie = pgcookie;
 }
 
+/*
+ * mpool_zcache --
+ *      Size the compressed tier; a budget of 0 bytes turns it off, writing
+ *      any dirty pages it holds to the file.
+ */
+
+int
+mpool_zcache(MPOOL *mp, unsigned long maxbytes)
+{
+        ZBKT *zp;
+
+        if (maxbytes != 0 && mp->zpage == NULL &&
+            (mp->zpage = malloc(mp->pagesize * 2)) == NULL)
+                return (RET_ERROR);
+
+        mp->zmax = maxbytes;
+        while (mp->zbytes > mp->zmax && (zp = TAILQ_FIRST(&mp->zlqh)) != NULL)
+                if (mpool_zdrop(mp, zp, 1) == RET_ERROR)
+                        return (RET_ERROR);
+
+        if (maxbytes == 0) {
+                free(mp->zpage);
+                mp->zpage = NULL;
+        }
+        return (RET_SUCCESS);
+}
+
 /*
  * mpool_new --
  *      Get a new page of memory.
@@ -123,14 +163,13 @@ mpool_new(MPOOL *mp, pgno_t *pgnoaddr, unsigned int flags)
 {
         struct _hqh *head;
         BKT *bp;
+        ZBKT *zp;
 
         if (mp->npages == MAX_PAGE_NUMBER) {
                 (void)fprintf(stderr, "mpool_new: page allocation overflow.\n");
                 abort();
         }
-#ifdef STATISTICS
         ++mp->pagenew;
-#endif /* ifdef STATISTICS */
 
         /*
          * Get a BKT from the cache.  Assign a new page number, attach
@@ -146,6 +185,10 @@ mpool_new(MPOOL *mp, pgno_t *pgnoaddr, unsigned int flags)
         } else
                 bp->pgno = *pgnoaddr = mp->npages++;
 
+        /* A requested page number may have an old compressed image. */
+        if (mp->zbytes != 0 && (zp = mpool_zlook(mp, bp->pgno)) != NULL)
+                (void)mpool_zdrop(mp, zp, 0);
+
         bp->flags = MPOOL_PINNED | MPOOL_INUSE;
 
         head = &mp->hqh[HASHKEY(bp->pgno)];
@@ -192,11 +235,9 @@ mpool_get(MPOOL *mp, pgno_t pgno,
         struct _hqh *head;
         BKT *bp;
         off_t off;
-        int nr;
+        int nr, zflags;
 
-#ifdef STATISTICS
         ++mp->pageget;
-#endif /* ifdef STATISTICS */
 
         /* Check for a page that is cached. */
         if ((bp = mpool_look(mp, pgno)) != NULL) {
@@ -228,6 +269,30 @@ mpool_get(MPOOL *mp, pgno_t pgno,
         if ((bp = mpool_bkt(mp)) == NULL)
                 return (NULL);
 
+        /*
+         * Check the compressed tier.  Its images are already in the in-core
+         * format, so they don't go through the user's input filter again.
+         */
+        if (mp->zbytes != 0 &&
+            (zflags = mpool_zget(mp, pgno, bp->page)) != -1) {
+                if (zflags == -2) {
+                        free(bp);
+                        mp->curcache--;
+                        errno = EINVAL;
+                        return (NULL);
+                }
+                ++mp->zhit;
+                bp->pgno = pgno;
+                bp->flags = zflags & MPOOL_DIRTY;
+                if (!(flags & MPOOL_IGNOREPIN))
+                        bp->flags |= MPOOL_PINNED;
+                bp->flags |= MPOOL_INUSE;
+                head = &mp->hqh[HASHKEY(bp->pgno)];
+                TAILQ_INSERT_HEAD(head, bp, hq);
+                TAILQ_INSERT_TAIL(&mp->lqh, bp, q);
+                return (bp->page);
+        }
+
         /* Read in the contents. */
         off = mp->pagesize * pgno;
         if ((nr = pread(mp->fd, bp->page, mp->pagesize, off)) != mp->pagesize) {
@@ -252,9 +317,7 @@ mpool_get(MPOOL *mp, pgno_t pgno,
                         return (NULL);
                 }
         }
-#ifdef STATISTICS
         ++mp->pageread;
-#endif /* ifdef STATISTICS */
 
         /* Set the page number, pin the page. */
         bp->pgno = pgno;
@@ -288,9 +351,7 @@ mpool_put(MPOOL *mp, void *page, unsigned int flags)
 {
         BKT *bp;
 
-#ifdef STATISTICS
         ++mp->pageput;
-#endif /* ifdef STATISTICS */
         bp = (BKT *)((char *)page - sizeof(BKT));
 #ifdef DEBUG
         if (!(bp->flags & MPOOL_PINNED)) {
@@ -314,6 +375,7 @@ int
 mpool_close(MPOOL *mp)
 {
         BKT *bp;
+        ZBKT *zp;
 
         /* Free up any space allocated to the lru pages. */
         while ((bp = TAILQ_FIRST(&mp->lqh))) {
@@ -321,6 +383,13 @@ mpool_close(MPOOL *mp)
                 free(bp);
         }
 
+        /* Free up the compressed tier. */
+        while ((zp = TAILQ_FIRST(&mp->zlqh))) {
+                TAILQ_REMOVE(&mp->zlqh, zp, q);
+                free(zp);
+        }
+        free(mp->zpage);
+
         /* Free the MPOOL cookie. */
         free(mp);
         return (RET_SUCCESS);
@@ -335,6 +404,7 @@ int
 mpool_sync(MPOOL *mp)
 {
         BKT *bp;
+        ZBKT *zp;
 
         /* Walk the lru chain, flushing any dirty pages to disk. */
         TAILQ_FOREACH(bp, &mp->lqh, q)
@@ -342,6 +412,16 @@ mpool_sync(MPOOL *mp)
                     mpool_write(mp, bp) == RET_ERROR)
                         return (RET_ERROR);
 
+        /* Then the compressed tier; the images stay cached, but clean. */
+        TAILQ_FOREACH(zp, &mp->zlqh, q)
+                if (zp->flags & MPOOL_DIRTY) {
+                        if (mpool_lzdecomp(zp->data, zp->len,
+                            mp->zpage, mp->pagesize) ||
+                            mpool_pwrite(mp, zp->pgno, mp->zpage))
+                                return (RET_ERROR);
+                        zp->flags &= ~MPOOL_DIRTY;
+                }
+
         /* Sync the file descriptor. */
         return (fsync(mp->fd) ? RET_ERROR : RET_SUCCESS);
 }
@@ -356,6 +436,7 @@ mpool_bkt(MPOOL *mp)
 {
         struct _hqh *head;
         BKT *bp;
+        int rv;
 
         /* If under the max cached, always create a new page. */
         if (mp->curcache < mp->maxcache)
@@ -370,13 +451,16 @@ mpool_bkt(MPOOL *mp)
 
         TAILQ_FOREACH(bp, &mp->lqh, q)
                 if (!(bp->flags & MPOOL_PINNED)) {
-                        /* Flush if dirty. */
-                        if (bp->flags & MPOOL_DIRTY &&
+                        /* Compress it, or flush if dirty. */
+                        rv = mp->zmax == 0 ?
+                            RET_SPECIAL : mpool_zput(mp, bp);
+                        if (rv == RET_ERROR)
+                                return (NULL);
+                        if (rv == RET_SPECIAL &&
+                            bp->flags & MPOOL_DIRTY &&
                             mpool_write(mp, bp) == RET_ERROR)
                                 return (NULL);
-#ifdef STATISTICS
                         ++mp->pageflush;
-#endif /* ifdef STATISTICS */
                         /* Remove from the hash and lru queues. */
                         head = &mp->hqh[HASHKEY(bp->pgno)];
                         TAILQ_REMOVE(head, bp, hq);
@@ -394,9 +478,7 @@ mpool_bkt(MPOOL *mp)
 
 new:    if ((bp = (BKT *)malloc(sizeof(BKT) + mp->pagesize)) == NULL)
                 return (NULL);
-#ifdef STATISTICS
         ++mp->pagealloc;
-#endif /* ifdef STATISTICS */
         memset(bp, 0xff, sizeof(BKT) + mp->pagesize);
         bp->page  = (char *)bp + sizeof(BKT);
         bp->flags = 0;
@@ -411,19 +493,32 @@ new:    if ((bp = (BKT *)malloc(sizeof(BKT) + mp->pagesize)) == NULL)
 
 static int
 mpool_write(MPOOL *mp, BKT *bp)
+{
+        if (mpool_pwrite(mp, bp->pgno, bp->page) == RET_ERROR)
+                return (RET_ERROR);
+
+        bp->flags &= ~MPOOL_DIRTY;
+        return (RET_SUCCESS);
+}
+
+/*
+ * mpool_pwrite
+ *      Write a page image to disk.
+ */
+
+static int
+mpool_pwrite(MPOOL *mp, pgno_t pgno, void *page)
 {
         off_t off;
 
-#ifdef STATISTICS
         ++mp->pagewrite;
-#endif /* ifdef STATISTICS */
 
         /* Run through the user's filter. */
         if (mp->pgout)
-                (mp->pgout)(mp->pgcookie, bp->pgno, bp->page);
+                (mp->pgout)(mp->pgcookie, pgno, page);
 
-        off = mp->pagesize * bp->pgno;
-        if (pwrite(mp->fd, bp->page, mp->pagesize, off) != mp->pagesize)
+        off = mp->pagesize * pgno;
+        if (pwrite(mp->fd, page, mp->pagesize, off) != mp->pagesize)
                 return (RET_ERROR);
 
         /*
@@ -434,12 +529,232 @@ mpool_write(MPOOL *mp, BKT *bp)
          */
 
         if (mp->pgin)
-                (mp->pgin)(mp->pgcookie, bp->pgno, bp->page);
+                (mp->pgin)(mp->pgcookie, pgno, page);
 
-        bp->flags &= ~MPOOL_DIRTY;
         return (RET_SUCCESS);
 }
 
+/*
+ * mpool_zput
+ *      Move a page leaving the lru chain into the compressed tier.
+ *      Returns RET_SPECIAL if the page doesn't compress well enough to be
+ *      worth keeping, in which case the caller handles it as before.
+ */
+
+static int
+mpool_zput(MPOOL *mp, BKT *bp)
+{
+        ZBKT *zp;
+        size_t len;
+        unsigned char *zbuf;
+
+        zbuf = (unsigned char *)mp->zpage + mp->pagesize;
+        len = mpool_lzcomp(bp->page, mp->pagesize,
+            zbuf, mp->pagesize - mp->pagesize / 8);
+        if (len == 0 || len > mp->zmax) {
+                ++mp->zreject;
+                return (RET_SPECIAL);
+        }
+
+        /* Make room, oldest first. */
+        while (mp->zbytes + len > mp->zmax &&
+            (zp = TAILQ_FIRST(&mp->zlqh)) != NULL)
+                if (mpool_zdrop(mp, zp, 1) == RET_ERROR)
+                        return (RET_ERROR);
+
+        if ((zp = malloc(offsetof(ZBKT, data) + len)) == NULL)
+                return (RET_SPECIAL);
+        memcpy(zp->data, zbuf, len);
+        zp->pgno  = bp->pgno;
+        zp->len   = len;
+        zp->flags = bp->flags & MPOOL_DIRTY;
+        TAILQ_INSERT_HEAD(&mp->zhqh[HASHKEY(zp->pgno)], zp, hq);
+        TAILQ_INSERT_TAIL(&mp->zlqh, zp, q);
+        mp->zbytes += len;
+        ++mp->zstore;
+        return (RET_SUCCESS);
+}
+
+/*
+ * mpool_zget
+ *      Take a page out of the compressed tier.  Returns its MPOOL_DIRTY
+ *      flag, -1 if the page isn't there, or -2 if it can't be expanded.
+ */
+
+static int
+mpool_zget(MPOOL *mp, pgno_t pgno, void *page)
+{
+        ZBKT *zp;
+        int flags;
+
+        if ((zp = mpool_zlook(mp, pgno)) == NULL)
+                return (-1);
+        if (mpool_lzdecomp(zp->data, zp->len, page, mp->pagesize))
+                return (-2);
+        flags = zp->flags;
+        (void)mpool_zdrop(mp, zp, 0);
+        return (flags);
+}
+
+/*
+ * mpool_zdrop
+ *      Discard a compressed page, optionally writing it first if dirty.
+ */
+
+static int
+mpool_zdrop(MPOOL *mp, ZBKT *zp, int flush)
+{
+        if (flush && zp->flags & MPOOL_DIRTY) {
+                if (mpool_lzdecomp(zp->data, zp->len, mp->zpage, mp->pagesize))
+                        return (RET_ERROR);
+                if (mpool_pwrite(mp, zp->pgno, mp->zpage) == RET_ERROR)
+                        return (RET_ERROR);
+        }
+        if (flush)
+                ++mp->zevict;
+        TAILQ_REMOVE(&mp->zhqh[HASHKEY(zp->pgno)], zp, hq);
+        TAILQ_REMOVE(&mp->zlqh, zp, q);
+        mp->zbytes -= zp->len;
+        free(zp);
+        return (RET_SUCCESS);
+}
+
+/*
+ * mpool_zlook
+ *      Lookup a page in the compressed tier.
+ */
+
+static ZBKT *
+mpool_zlook(MPOOL *mp, pgno_t pgno)
+{
+        ZBKT *zp;
+
+        TAILQ_FOREACH(zp, &mp->zhqh[HASHKEY(pgno)], hq)
+                if (zp->pgno == pgno)
+                        return (zp);
+        return (NULL);
+}
+
+/*
+ * The compressed tier uses a small LZ77 coder, tuned for speed rather than
+ * ratio; B-tree pages of text lines typically shrink by 3-5x.  The encoded
+ * stream is a sequence of items, each starting with a control byte:
+ *
+ *      0nnnnnnn                n + 1 literal bytes follow
+ *      1nnnnnnn hhhhhhhh llllllll
+ *                              copy n + LZ_MINMATCH bytes starting
+ *                              (hhhhhhhh << 8 | llllllll) bytes back
+ */
+#define LZ_MINMATCH     4
+#define LZ_MAXLIT       128
+#define LZ_MAXMATCH     (0x7f + LZ_MINMATCH)
+#define LZ_MAXOFF       0xffff
+#define LZ_HASHBITS     12
+#define LZ_HASH(p)                                                      \
+        ((((u_int32_t)(p)[0] | (u_int32_t)(p)[1] << 8 |                 \
+        (u_int32_t)(p)[2] << 16 | (u_int32_t)(p)[3] << 24) *            \
+        2654435761U) >> (32 - LZ_HASHBITS))
+
+/*
+ * mpool_lzcomp
+ *      Compress a page; returns 0 if the result won't fit in outmax bytes.
+ */
+
+static size_t
+mpool_lzcomp(const unsigned char *in, size_t inlen,
+    unsigned char *out, size_t outmax)
+{
+        u_int32_t htab[1 << LZ_HASHBITS];
+        const unsigned char *ip, *iend, *lit, *ref;
+        unsigned char *op, *oend;
+        size_t len, n, off;
+        u_int32_t h;
+
+        memset(htab, 0, sizeof(htab));
+        ip = lit = in;
+        iend = in + inlen;
+        op = out;
+        oend = out + outmax;
+
+        while (ip + LZ_MINMATCH <= iend) {
+                h = LZ_HASH(ip);
+                ref = htab[h] == 0 ? NULL : in + htab[h] - 1;
+                htab[h] = ip - in + 1;
+                if (ref == NULL || (off = ip - ref) > LZ_MAXOFF ||
+                    memcmp(ref, ip, LZ_MINMATCH)) {
+                        ++ip;
+                        continue;
+                }
+                for (len = LZ_MINMATCH; ip + len < iend &&
+                    len < LZ_MAXMATCH && ref[len] == ip[len]; ++len);
+
+                /* Flush the pending literals, then the match. */
+                for (; lit < ip; lit += n, op += n) {
+                        n = ip - lit > LZ_MAXLIT ? LZ_MAXLIT : ip - lit;
+                        if (op + 1 + n > oend)
+                                return (0);
+                        *op++ = n - 1;
+                        memcpy(op, lit, n);
+                }
+                if (op + 3 > oend)
+                        return (0);
+                *op++ = 0x80 | (len - LZ_MINMATCH);
+                *op++ = off >> 8;
+                *op++ = off & 0xff;
+                ip += len;
+                lit = ip;
+        }
+        for (; lit < iend; lit += n, op += n) {
+                n = iend - lit > LZ_MAXLIT ? LZ_MAXLIT : iend - lit;
+                if (op + 1 + n > oend)
+                        return (0);
+                *op++ = n - 1;
+                memcpy(op, lit, n);
+        }
+        return (op - out);
+}
+
+/*
+ * mpool_lzdecomp
+ *      Expand a page; the result must be exactly outlen bytes.
+ */
+
+static int
+mpool_lzdecomp(const unsigned char *in, size_t inlen,
+    unsigned char *out, size_t outlen)
+{
+        const unsigned char *ip, *iend, *ref;
+        unsigned char *op, *oend;
+        size_t n, off;
+
+        ip = in;
+        iend = in + inlen;
+        op = out;
+        oend = out + outlen;
+        while (ip < iend) {
+                if (*ip < 0x80) {
+                        n = *ip++ + 1;
+                        if (n > (size_t)(iend - ip) || n > (size_t)(oend - op))
+                                return (1);
+                        memcpy(op, ip, n);
+                        ip += n;
+                        op += n;
+                        continue;
+                }
+                n = (*ip++ & 0x7f) + LZ_MINMATCH;
+                if (iend - ip < 2)
+                        return (1);
+                off = ip[0] << 8 | ip[1];
+                ip += 2;
+                if (off == 0 || off > (size_t)(op - out) ||
+                    n > (size_t)(oend - op))
+                        return (1);
+                for (ref = op - off; n > 0; --n)
+                        *op++ = *ref++;
+        }
+        return (op != oend);
+}
+
 /*
  * mpool_look
  *      Lookup a page in the cache.
@@ -455,14 +770,10 @@ mpool_look(MPOOL *mp, pgno_t pgno)
         TAILQ_FOREACH(bp, head, hq)
                 if ((bp->pgno == pgno) &&
                         ((bp->flags & MPOOL_INUSE) == MPOOL_INUSE)) {
-#ifdef STATISTICS
                         ++mp->cachehit;
-#endif /* ifdef STATISTICS */
                         return (bp);
                 }
-#ifdef STATISTICS
         ++mp->cachemiss;
-#endif /* ifdef STATISTICS */
         return (NULL);
 }
 
@@ -498,6 +809,11 @@ mpool_stat(MPOOL *mp)
                     * 100, mp->cachehit, mp->cachemiss);
         (void)fprintf(stderr, "%lu page reads, %lu page writes\n",
             mp->pageread, mp->pagewrite);
+        if (mp->zmax)
+                (void)fprintf(stderr, "compressed tier: %lu of %lu bytes, "
+                    "%lu stores, %lu hits, %lu rejects, %lu evictions\n",
+                    mp->zbytes, mp->zmax, mp->zstore, mp->zhit,
+                    mp->zreject, mp->zevict);
 
         sep = "";
         cnt = 0;
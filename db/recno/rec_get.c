@@ -100,7 +100,7 @@ __rec_get(const DB *dbp, const DBT *key, DBT *data, unsigned int flags)
         }
 
         --nrec;
-        if ((e = __rec_search(t, nrec, SEARCH)) == NULL)
+        if ((e = __rec_search(t, nrec, SREAD)) == NULL)
                 return (RET_ERROR);
 
         status = __rec_ret(t, e, 0, NULL, data);
@@ -212,8 +212,12 @@ __rec_vpipe(BTREE *t, recno_t top)
                                 p = (unsigned char *)t->bt_rdata.data + len;
                         }
                 }
-                if (ch == EOF)
+                if (ch == EOF) {
+                        /* A last line without a newline was still read. */
+                        if (data.size != 0)
+                                ++nrec;
                         break;
+                }
         }
         if (nrec < top) {
                 F_SET(t, R_EOF);
@@ -87,6 +87,7 @@ __rec_open(const char *fname, int flags, int mode, const RECNOINFO *openinfo,
                 btopeninfo.compare    = NULL;
                 btopeninfo.prefix     = NULL;
                 btopeninfo.lorder     = openinfo->lorder;
+                btopeninfo.zcachesize = openinfo->zcachesize;
                 dbp = __bt_open(openinfo->bfname,
                     O_RDWR, S_IRUSR | S_IWUSR, &btopeninfo, dflags);
         } else
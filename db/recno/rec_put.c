@@ -197,12 +197,37 @@ __rec_iput(BTREE *t, recno_t nrec, const DBT *data, unsigned int flags)
         DBT tdata;
         EPG *e;
         PAGE *h;
+        RLEAF *rl;
         indx_t idx, nxtindex;
         pgno_t pg;
         u_int32_t nbytes;
         int dflags, status;
         char *dest, db[NOVFLSIZE];
 
+        /*
+         * If an overflow record is being replaced by another, rewrite the
+         * existing chain in place, so that editing a very long line only
+         * dirties the pages that change instead of copying the whole line
+         * into a new chain.
+         */
+
+        if (flags != R_IAFTER && flags != R_IBEFORE &&
+            nrec < t->bt_nrecs && data->size > t->bt_ovflsize) {
+                if ((e = __rec_search(t, nrec, SREAD)) == NULL)
+                        return (RET_ERROR);
+                h = e->page;
+                rl = GETRLEAF(h, e->index);
+                if (rl->flags & P_BIGDATA) {
+                        status = __ovfl_update(t, rl->bytes, data);
+                        if (status == RET_SUCCESS)
+                                F_SET(t, B_MODIFIED);
+                        mpool_put(t->bt_mp, h,
+                            status == RET_SUCCESS ? MPOOL_DIRTY : 0);
+                        return (status);
+                }
+                mpool_put(t->bt_mp, h, 0);
+        }
+
         /*
          * If the data won't fit on a page, store it on indirect pages.
          *
@@ -225,12 +250,27 @@ __rec_iput(BTREE *t, recno_t nrec, const DBT *data, unsigned int flags)
         /* __rec_search pins the returned page. */
         if ((e = __rec_search(t, nrec,
             nrec > t->bt_nrecs || flags == R_IAFTER || flags == R_IBEFORE ?
-            SINSERT : SEARCH)) == NULL)
+            SINSERT : SPUT)) == NULL)
                 return (RET_ERROR);
 
         h = e->page;
         idx = e->index;
 
+        /*
+         * A page found without descending the tree has no parent stack for
+         * a split to update; if it may have to split, descend the tree.
+         */
+
+        nbytes = NRLEAFDBT(data->size);
+        if (h->pgno != P_ROOT && t->bt_sp == t->bt_stack &&
+            h->upper - h->lower < nbytes + sizeof(indx_t)) {
+                mpool_put(t->bt_mp, h, 0);
+                if ((e = __rec_search(t, nrec, SEARCH)) == NULL)
+                        return (RET_ERROR);
+                h = e->page;
+                idx = e->index;
+        }
+
         /*
          * Add the specified key/data pair to the tree.  The R_IAFTER and
          * R_IBEFORE flags insert the key after/before the specified key.
@@ -259,8 +299,8 @@ __rec_iput(BTREE *t, recno_t nrec, const DBT *data, unsigned int flags)
          * the offset array, shift the pointers up.
          */
 
-        nbytes = NRLEAFDBT(data->size);
         if (h->upper - h->lower < nbytes + sizeof(indx_t)) {
+                t->bt_rdpgno = P_INVALID;
                 status = __bt_split(t, h, NULL, data, dflags, nbytes, idx);
                 if (status == RET_SUCCESS)
                         ++t->bt_nrecs;
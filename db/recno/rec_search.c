@@ -78,11 +78,51 @@ __rec_search(BTREE *t, recno_t recno, enum SRCHOP op)
         recno_t total;
         int sverrno;
 
+        /*
+         * Reads (SREAD) are usually of the records in order, and scanning
+         * the internal pages from the root is most of the cost of finding
+         * a record in a large tree.  Remember the leaf page the last read
+         * ended on, and if the record is on it, or on the page after it,
+         * skip the descent.  Replacing or appending a record (SPUT) doesn't
+         * change the internal pages either, and may also use the page; an
+         * append goes at the end of the last one.  Any other operation may
+         * change the tree, and forgets the page.
+         *
+         * A page found this way has no parent stack.
+         */
         BT_CLR(t);
+        if (op != SREAD && op != SPUT)
+                t->bt_rdpgno = P_INVALID;
+        else if (t->bt_rdpgno != P_INVALID && recno >= t->bt_rdbase) {
+                if ((h = mpool_get(t->bt_mp, t->bt_rdpgno, 0)) == NULL)
+                        goto err;
+                if (recno - t->bt_rdbase >= NEXTINDEX(h) &&
+                    (pg = h->nextpg) != P_INVALID) {
+                        t->bt_rdbase += NEXTINDEX(h);
+                        mpool_put(t->bt_mp, h, 0);
+                        if ((h = mpool_get(t->bt_mp, pg, 0)) == NULL)
+                                goto err;
+                        t->bt_rdpgno = pg;
+                }
+                if (h->flags & P_RLEAF &&
+                    (recno - t->bt_rdbase < NEXTINDEX(h) || (op == SPUT &&
+                    recno - t->bt_rdbase == NEXTINDEX(h) &&
+                    h->nextpg == P_INVALID))) {
+                        t->bt_cur.page = h;
+                        t->bt_cur.index = recno - t->bt_rdbase;
+                        return (&t->bt_cur);
+                }
+                mpool_put(t->bt_mp, h, 0);
+        }
+
         for (pg = P_ROOT, total = 0;;) {
                 if ((h = mpool_get(t->bt_mp, pg, 0)) == NULL)
                         goto err;
                 if (h->flags & P_RLEAF) {
+                        if (op == SREAD || op == SPUT) {
+                                t->bt_rdpgno = pg;
+                                t->bt_rdbase = total;
+                        }
                         t->bt_cur.page = h;
                         t->bt_cur.index = recno - total;
                         return (&t->bt_cur);
@@ -107,6 +147,8 @@ __rec_search(BTREE *t, recno_t recno, enum SRCHOP op)
                         mpool_put(t->bt_mp, h, MPOOL_DIRTY);
                         break;
                 case SEARCH:
+                case SREAD:
+                case SPUT:
                         mpool_put(t->bt_mp, h, 0);
                         break;
                 }
@@ -114,7 +156,8 @@ __rec_search(BTREE *t, recno_t recno, enum SRCHOP op)
         }
         /* Try and recover the tree. */
 err:    sverrno = errno;
-        if (op != SEARCH)
+        t->bt_rdpgno = P_INVALID;
+        if (op == SDELETE || op == SINSERT)
                 while  ((parent = BT_POP(t)) != NULL) {
                         if ((h = mpool_get(t->bt_mp, parent->pgno, 0)) == NULL)
                                 break;
@@ -119,7 +119,7 @@ einval:         errno = EINVAL;
                         return (RET_SPECIAL);
         }
 
-        if ((e = __rec_search(t, nrec - 1, SEARCH)) == NULL)
+        if ((e = __rec_search(t, nrec - 1, SREAD)) == NULL)
                 return (RET_ERROR);
 
         F_SET(&t->bt_cursor, CURS_INIT);
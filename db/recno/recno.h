@@ -39,7 +39,7 @@
  *      @(#)recno.h     8.1 (Berkeley) 6/4/93
  */
 
-enum SRCHOP { SDELETE, SINSERT, SEARCH};        /* Rec_search operation. */
+enum SRCHOP { SDELETE, SINSERT, SEARCH, SREAD, SPUT}; /* Rec_search operation. */
 
 #include "../btree/btree.h"
 #include "extern.h"
@@ -38,6 +38,8 @@ static EXCMDLIST const *
 static int      ex_discard(SCR *);
 static int      ex_line(SCR *, EXCMD *, MARK *, int *, int *);
 static int      ex_load(SCR *);
+static void     ex_plan(SCR *, EXCMD *);
+static void     ex_plan_free(EXCMD *);
 static void     ex_unknown(SCR *, char *, size_t);
 
 /*
@@ -207,15 +209,16 @@ ex_cmd(SCR *sp)
         enum nresult nret;
         EX_PRIVATE *exp;
         EXCMD *ecp;
+        EXPLAN *pp;
         GS *gp;
         MARK cur;
         recno_t lno;
         size_t arg1_len, discard, len;
         u_int32_t flags;
         long ltmp;
-        int at_found, gv_found;
+        int at_found, gv_found, i;
         int ch, cnt, delim, isaddr, namelen;
-        int newscreen, notempty, tmp, vi_address;
+        int newscreen, notempty, planok, tmp, vi_address;
         char *arg1, *p, *s, *t;
 
         gp = sp->gp;
@@ -263,6 +266,13 @@ loop:   ecp = LIST_FIRST(&gp->ecq);
         arg1 = NULL;
         ecp->save_cmdlen = 0;
 
+        /*
+         * An @/global command's parse can only be saved, or reused, when
+         * starting on its text.
+         */
+        pp = NULL;
+        planok = FL_ISSET(ecp->agv_flags, AGV_ALL) && ecp->cp == ecp->o_cp;
+
         /* Skip <blank>s, empty lines.  */
         for (notempty = 0; ecp->clen > 0; ++ecp->cp, --ecp->clen)
                 if ((ch = *ecp->cp) == '\n') {
@@ -350,11 +360,27 @@ loop:   ecp = LIST_FIRST(&gp->ecq);
             ecp->clen != 0 && (ecp->clen != 1 || ecp->cp[0] != '\004'))
                 F_CLR(ecp, E_NRSEP);
 
+        /* Reuse a saved parse. */
+        if (planok && ecp->plan != NULL) {
+                pp = ecp->plan;
+                if (pp->cmd == &pp->rcmd) {
+                        ecp->rcmd = pp->rcmd;
+                        ecp->cmd = &ecp->rcmd;
+                } else
+                        ecp->cmd = pp->cmd;
+                newscreen = 0;
+                arg1_len = 0;
+                vi_address = 1;
+                goto plan_cmd;
+        }
+
         /* Parse command addresses. */
         if (ex_range(sp, ecp, &tmp))
                 goto rfail;
         if (tmp)
                 goto err;
+        if (ecp->addrcnt != 0)
+                planok = 0;
 
         /*
          * Skip <blank>s and any more colons (the command :3,5:print
@@ -548,6 +574,8 @@ skip_srch:      if (ecp->cmd == &cmds[C_VISUAL_EX] && F_ISSET(sp, SC_VI))
                         exp->fdef = E_C_PRINT;
                 F_CLR(ecp, E_USELASTCMD);
         } else {
+                planok = 0;
+
                 /* Print is the default command. */
                 ecp->cmd = &cmds[C_PRINT];
 
@@ -576,6 +604,7 @@ skip_srch:      if (ecp->cmd == &cmds[C_VISUAL_EX] && F_ISSET(sp, SC_VI))
          * command was entered, e.g. <CR>'s after the set didn't change to
          * the new format, but :1p would.
          */
+plan_cmd:
         if (O_ISSET(sp, O_NUMBER)) {
                 F_SET(ecp, E_OPTNUM);
                 FL_SET(ecp->iflags, E_C_HASH);
@@ -593,6 +622,18 @@ skip_srch:      if (ecp->cmd == &cmds[C_VISUAL_EX] && F_ISSET(sp, SC_VI))
         F_SET(ecp, ecp->cmd->flags);
         if (!newscreen)
                 F_CLR(ecp, E_NEWSCREEN);
+        else
+                planok = 0;
+
+        /* A saved parse has no command text left to look at. */
+        if (pp != NULL) {
+                ecp->save_cmd = ecp->cp;
+                ecp->save_cmdlen = 0;
+                ecp->clen = 0;
+                if (pp->nlend)
+                        F_SET(ecp, E_NEWLINE);
+                goto plan_addr;
+        }
 
         /*
          * There are three normal termination cases for an ex command.  They
@@ -848,6 +889,7 @@ skip_srch:      if (ecp->cmd == &cmds[C_VISUAL_EX] && F_ISSET(sp, SC_VI))
          * (ex: z) care if the user specified an address or if we just used
          * the current cursor.
          */
+plan_addr:
         switch (F_ISSET(ecp, E_ADDR1 | E_ADDR2 | E_ADDR2_ALL | E_ADDR2_NONE)) {
         case E_ADDR1:                           /* One address: */
                 switch (ecp->addrcnt) {
@@ -944,6 +986,19 @@ two_addr:       switch (ecp->addrcnt) {
                         ecp->addr2.lno = lno;
         }
 
+        /* The rest of a saved parse doesn't depend on the line. */
+        if (pp != NULL) {
+                ecp->buffer = pp->buffer;
+                ecp->count = pp->count;
+                ecp->flagoff = pp->flagoff;
+                FL_SET(ecp->iflags, pp->iflags);
+                exp->fdef = pp->fdef;
+                for (i = 0, p = pp->args; i < pp->argc; p += pp->alen[i++])
+                        if (argv_exp0(sp, ecp, p, pp->alen[i]))
+                                goto err;
+                goto addr_verify;
+        }
+
         ecp->flagoff = 0;
         for (p = ecp->cmd->syntax; *p != '\0'; ++p) {
                 /*
@@ -1090,6 +1145,7 @@ end_case23:             break;
                          * line addresses.
                          */
                         if (*p == 'a') {
+                                planok = 0;
                                 ecp->addr1 = ecp->addr2;
                                 ecp->addr2.lno = ecp->addr1.lno + ltmp - 1;
                         } else
@@ -1097,6 +1153,7 @@ end_case23:             break;
                         FL_SET(ecp->iflags, E_C_COUNT);
                         break;
                 case 'f':                               /* file */
+                        planok = 0;
                         if (argv_exp2(sp, ecp, ecp->cp, ecp->clen))
                                 goto err;
                         goto arg_cnt_chk;
@@ -1109,6 +1166,7 @@ end_case23:             break;
                          * searching the file.  Push ourselves onto the state
                          * stack.
                          */
+                        planok = 0;
                         if (ex_line(sp, ecp, &cur, &isaddr, &tmp))
                                 goto rfail;
                         if (tmp)
@@ -1132,6 +1190,7 @@ end_case23:             break;
                         break;
                 case 'S':                               /* string, file exp. */
                         if (ecp->clen != 0) {
+                                planok = 0;
                                 if (argv_exp1(sp, ecp, ecp->cp,
                                     ecp->clen, ecp->cmd == &cmds[C_BANG]))
                                         goto err;
@@ -1152,6 +1211,7 @@ end_case23:             break;
                          *
                          * First there was the word.
                          */
+                        planok = 0;
                         for (p = t = ecp->cp;
                             ecp->clen > 0; --ecp->clen, ++ecp->cp) {
                                 ch = *ecp->cp;
@@ -1194,6 +1254,7 @@ end_case23:             break;
                                 goto err;
                         goto addr_verify;
                 case 'w':                               /* word */
+                        planok = 0;
                         if (argv_exp3(sp, ecp, ecp->cp, ecp->clen))
                                 goto err;
 arg_cnt_chk:            if (*++p != 'N') {              /* N */
@@ -1241,6 +1302,10 @@ usage:          msgq(sp, M_ERR, "Usage: %s", ecp->cmd->usage);
          * If it's a "default vi command", an address of zero is okay.
          */
 addr_verify:
+        if (planok && pp == NULL && ecp->plan == NULL &&
+            ecp->save_cmdlen == 0 && arg1_len == 0)
+                ex_plan(sp, ecp);
+
         switch (ecp->addrcnt) {
         case 2:
                 /*
@@ -2127,6 +2192,7 @@ ex_load(SCR *sp)
                                 }
                         }
                         free(ecp->o_cp);
+                        ex_plan_free(ecp);
                 }
 
                 /* Discard the EXCMD. */
@@ -2150,6 +2216,65 @@ ex_load(SCR *sp)
         return (0);
 }
 
+/*
+ * ex_plan --
+ *      Save the parse of an @/global command for the rest of its lines.
+ */
+static void
+ex_plan(SCR *sp, EXCMD *ecp)
+{
+        EXPLAN *pp;
+        size_t len;
+        int i;
+        char *p;
+
+        if (ecp->argc > EXPLAN_ARGS)
+                return;
+        for (len = 0, i = 0; i < ecp->argc; ++i)
+                len += ecp->argv[i]->len;
+
+        CALLOC(sp, pp, 1, sizeof(EXPLAN));
+        if (pp == NULL)
+                return;
+        MALLOC(sp, pp->args, len + 1);
+        if (pp->args == NULL) {
+                free(pp);
+                return;
+        }
+        for (p = pp->args, i = 0; i < ecp->argc; p += pp->alen[i++]) {
+                pp->alen[i] = ecp->argv[i]->len;
+                memcpy(p, ecp->argv[i]->bp, pp->alen[i]);
+        }
+        pp->argc = ecp->argc;
+
+        if (ecp->cmd == &ecp->rcmd) {
+                pp->rcmd = ecp->rcmd;
+                pp->cmd = &pp->rcmd;
+        } else
+                pp->cmd = ecp->cmd;
+        pp->buffer = ecp->buffer;
+        pp->count = ecp->count;
+        pp->flagoff = ecp->flagoff;
+        pp->iflags = ecp->iflags;
+        pp->fdef = EXP(sp)->fdef;
+        pp->nlend = F_ISSET(ecp, E_NEWLINE) != 0;
+        ecp->plan = pp;
+}
+
+/*
+ * ex_plan_free --
+ *      Discard the saved parse of an @/global command.
+ */
+static void
+ex_plan_free(EXCMD *ecp)
+{
+        if (ecp->plan != NULL) {
+                free(ecp->plan->args);
+                free(ecp->plan);
+                ecp->plan = NULL;
+        }
+}
+
 /*
  * ex_discard --
  *      Discard any pending ex commands.
@@ -2172,6 +2297,7 @@ ex_discard(SCR *sp)
                                 free(rp);
                         }
                         free(ecp->o_cp);
+                        ex_plan_free(ecp);
                 }
                 LIST_REMOVE(ecp, q);
                 free(ecp);
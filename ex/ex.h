@@ -77,6 +77,27 @@ struct _range {                         /* Global command range.    */
         recno_t start, stop;            /* Start/stop of the range. */
 };
 
+/*
+ * Parsed @/global command.  A body that's a single command, without addresses
+ * or arguments that depend on the current line or file, is parsed once, and
+ * the parse is reused for the rest of the lines.
+ */
+typedef struct _explan EXPLAN;
+struct _explan {
+        EXCMDLIST const *cmd;           /* Command: entry in command table.  */
+        EXCMDLIST rcmd;                 /* Command: table entry/replacement. */
+        CHAR_T    buffer;               /* Command: named buffer.            */
+        long      count;                /* Command: signed count.            */
+        long      flagoff;              /* Command: signed flag offset.      */
+        u_int16_t iflags;               /* Command: user input information.  */
+        u_int32_t fdef;                 /* Default command flags after.      */
+        int       nlend;                /* Ended with a <newline>.           */
+#define EXPLAN_ARGS     2               /* Maximum arguments.                */
+        int       argc;                 /* Command: count of arguments.      */
+        size_t    alen[EXPLAN_ARGS];    /* Command: argument lengths.        */
+        char     *args;                 /* Command: arguments.               */
+};
+
 /* Ex command structure. */
 struct _excmd {
         LIST_ENTRY(_excmd) q;           /* Linked list of commands */
@@ -102,6 +123,7 @@ struct _excmd {
         recno_t   range_lno;            /* @/global range: set line number.  */
         char     *o_cp;                 /* Original @/global command.        */
         size_t    o_clen;               /* Original @/global command length. */
+        EXPLAN   *plan;                 /* Parsed @/global command.          */
 #define AGV_AT          0x01            /* @ buffer execution.               */
 #define AGV_AT_NORANGE  0x02            /* @ buffer execution without range. */
 #define AGV_GLOBAL      0x04            /* global command.                   */
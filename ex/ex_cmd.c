@@ -314,6 +314,11 @@ EXCMDLIST const cmds[] = {
             "f1r",
             "so[urce] file",
             "read a file of ex commands"},
+/* C_SORT */
+        {"sort",        ex_sort,        E_ADDR2_ALL,
+            "!s",
+            "[line [,line]] sor[t][!] [inru] [/RE/]",
+            "sort lines"},
 /* C_STOP */
         {"stop",        ex_stop,        E_SECURE,
             "!",
@@ -324,6 +329,11 @@ EXCMDLIST const cmds[] = {
             "!",
             "su[spend][!]",
             "suspend the edit session"},
+/* C_STATS */
+        {"stats",       ex_stats,       0,
+            "!",
+            "stats[!]",
+            "display performance counters"},
 /* C_T */
         {"t",           ex_copy,        E_ADDR2|E_AUTOPRINT,
             "l1",
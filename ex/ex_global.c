@@ -209,7 +209,7 @@ usage:          ex_emsg(sp, cmdp->cmd->usage, EXM_USAGE);
                 match[0].rm_so = 0;
                 match[0].rm_eo = len;
                 switch (eval =
-                    regexec(&sp->re_c, dbp, 0, match, REG_STARTEND)) {
+                    re_exec(sp, &sp->re_c, dbp, 0, match, REG_STARTEND)) {
                 case 0:
                         if (cmd == V)
                                 continue;
@@ -31,6 +31,7 @@
 #include <poll.h>
 #include <bsd_stdlib.h>
 #include <bsd_string.h>
+#include <time.h>
 
 #if defined(__solaris__)
 # define __EXTENSIONS__
@@ -94,7 +95,20 @@ static int      sscr_getprompt(SCR *);
 static int      sscr_init(SCR *);
 static int      sscr_insert(SCR *);
 static int      sscr_matchprompt(SCR *, char *, size_t, size_t *);
+static int      sscr_paint(SCR *, int);
+static int      sscr_repaint(GS *);
 static int      sscr_setprompt(SCR *, char *, size_t);
+static int      sscr_wait(GS *);
+
+/*
+ * Shell output is read SSCR_READ bytes at a time.  While more of it is
+ * waiting, up to SSCR_BATCH bytes are appended to the file before going
+ * back to check the keyboard, and the screen is updated no more often
+ * than every SSCR_PAINT milliseconds.
+ */
+#define SSCR_READ       (64 * 1024)
+#define SSCR_BATCH      (1024 * 1024)
+#define SSCR_PAINT      50
 
 /*
  * ex_script -- : sc[ript][!] [file]
@@ -141,6 +155,8 @@ sscr_init(SCR *sp)
         sp->script = sc;
         sc->sh_prompt = NULL;
         sc->sh_prompt_len = 0;
+        sc->sh_paint.tv_sec = sc->sh_paint.tv_nsec = 0;
+        sc->sh_stale = 0;
 
         /*
          * There are two different processes running through this code.
@@ -453,14 +469,21 @@ sscr_check_input(SCR *sp)
                 }
 
 loop:
-        /* Check for input. */
-        switch (poll(pfd, nfds, INFTIM)) {
+        /*
+         * Check for input, waking up when a scripting window is due the
+         * screen update its last output was denied.
+         */
+        switch (poll(pfd, nfds, sscr_wait(gp))) {
         case -1:
                 msgq(sp, M_SYSERR, "poll");
                 rval = 1;
-                /* FALLTHROUGH */
-        case 0:
                 goto done;
+        case 0:
+                if (sscr_repaint(gp)) {
+                        rval = 1;
+                        goto done;
+                }
+                goto loop;
         default:
                 break;
         }
@@ -547,12 +570,16 @@ loop:
         goto loop;
 done:
         free(pfd);
+
+        /* Bring the scripting windows up to date before reading keys. */
+        if (sscr_repaint(gp))
+                rval = 1;
         return (rval);
 }
 
 /*
  * sscr_insert --
- *      Take a line from the shell and insert it into the file.
+ *      Take lines from the shell and insert them into the file.
  */
 static int
 sscr_insert(SCR *sp)
@@ -561,7 +588,7 @@ sscr_insert(SCR *sp)
         SCRIPT *sc;
         struct pollfd pfd[1];
         recno_t lno;
-        size_t blen, len, tlen;
+        size_t blen, len, off, tlen, total;
         unsigned int value;
         int nr, rval;
         char *bp;
@@ -570,15 +597,25 @@ sscr_insert(SCR *sp)
         if (db_last(sp, &lno))
                 return (1);
 
-#define MINREAD 1024
-        GET_SPACE_RET(sp, bp, blen, MINREAD);
+        GET_SPACE_RET(sp, bp, blen, SSCR_READ);
         endp = bp;
 
         /* Read the characters. */
         rval = 1;
         sc = sp->script;
-more:   switch (nr = read(sc->sh_master, endp, MINREAD)) {
+        pfd[0].fd = sc->sh_master;
+        pfd[0].events = POLLIN;
+        len = total = 0;
+more:   off = endp - (CHAR_T *)bp;
+        ADD_SPACE_GOTO(sp, bp, blen, off + SSCR_READ);
+        endp = bp + off;
+        switch (nr = read(sc->sh_master, endp, SSCR_READ)) {
         case  0:                        /* EOF; shell just exited. */
+                if (sc->sh_stale) {
+                        sp->lno = lno;
+                        sp->cno = 0;
+                        (void)sscr_paint(sp, 1);
+                }
                 sscr_end(sp);
                 rval = 0;
                 goto ret;
@@ -587,19 +624,36 @@ more:   switch (nr = read(sc->sh_master, endp, MINREAD)) {
                 goto ret;
         default:
                 endp += nr;
+                total += nr;
                 break;
         }
 
-        /* Append the lines into the file. */
+        /*
+         * Append the lines into the file.  The screens aren't told about each
+         * one, they're reformatted once they're all in, see sscr_paint().
+         */
         for (p = t = bp; p < endp; ++p) {
                 value = KEY_VAL(sp, *p);
                 if (value == K_CR || value == K_NL) {
                         len = p - t;
-                        if (db_append(sp, 1, lno++, t, len))
+                        if (db_append(sp, 0, lno++, t, len))
                                 goto ret;
+                        sc->sh_stale = 1;
                         t = p + 1;
                 }
         }
+
+        /*
+         * If the shell has more output waiting, keep reading, carrying any
+         * partial line over, until enough has been read that the keyboard
+         * should be checked.
+         */
+        if (total < SSCR_BATCH && poll(pfd, 1, 0) > 0) {
+                memmove(bp, t, endp - t);
+                endp = bp + (endp - t);
+                goto more;
+        }
+
         if (p > t) {
                 len = p - t;
                 /*
@@ -610,8 +664,6 @@ more:   switch (nr = read(sc->sh_master, endp, MINREAD)) {
                  * confused the shell, or whatever.
                  */
                 if (!sscr_matchprompt(sp, t, len, &tlen) || tlen != 0) {
-                        pfd[0].fd = sc->sh_master;
-                        pfd[0].events = POLLIN;
                         if (poll(pfd, 1, 100) > 0) {
                                 memmove(bp, t, len);
                                 endp = bp + len;
@@ -619,18 +671,107 @@ more:   switch (nr = read(sc->sh_master, endp, MINREAD)) {
                         }
                 }
                 if (sscr_setprompt(sp, t, len))
-                        return (1);
-                if (db_append(sp, 1, lno++, t, len))
                         goto ret;
+                if (db_append(sp, 0, lno++, t, len))
+                        goto ret;
+                sc->sh_stale = 1;
         }
 
         /* The cursor moves to EOF. */
         sp->lno = lno;
         sp->cno = len ? len - 1 : 0;
-        rval = vs_refresh(sp, 1);
+        rval = sscr_paint(sp, 0);
 
 ret:    FREE_SPACE(sp, bp, blen);
         return (rval);
+
+alloc_err:
+        bp = NULL;                      /* Freed by binc(). */
+        goto ret;
+}
+
+/*
+ * sscr_paint --
+ *      Update the screen for lines appended by sscr_insert(), unless it was
+ *      updated less than SSCR_PAINT milliseconds ago and this isn't forced.
+ */
+static int
+sscr_paint(SCR *sp, int force)
+{
+        struct timespec ts;
+        SCRIPT *sc;
+        SCR *tsp;
+        long ms;
+
+        if ((sc = sp->script) == NULL || !sc->sh_stale)
+                return (0);
+
+        /*
+         * Lines appended since the last update may be shown as past the end
+         * of the file, in this or any other screen of the file; have
+         * vs_refresh() rebuild their maps from the top line.
+         */
+        TAILQ_FOREACH(tsp, &sp->gp->dq, q)
+                if (tsp->ep == sp->ep)
+                        F_SET(tsp, SC_SCR_REFORMAT);
+
+        (void)clock_gettime(CLOCK_MONOTONIC, &ts);
+        ms = (ts.tv_sec - sc->sh_paint.tv_sec) * 1000 +
+            (ts.tv_nsec - sc->sh_paint.tv_nsec) / 1000000;
+        if (!force && ms >= 0 && ms < SSCR_PAINT)
+                return (0);
+        sc->sh_paint = ts;
+        sc->sh_stale = 0;
+
+        /*
+         * If the cursor has gone off the bottom of the screen, put it on the
+         * last line, the way a terminal scrolls, rather than centering it.
+         */
+        if (sp->lno > TMAP->lno && vs_sm_fill(sp, sp->lno, P_BOTTOM))
+                return (1);
+        return (vs_refresh(sp, 1));
+}
+
+/*
+ * sscr_repaint --
+ *      Update the screens of any scripting windows that are due it.
+ */
+static int
+sscr_repaint(GS *gp)
+{
+        SCR *tsp;
+
+        TAILQ_FOREACH(tsp, &gp->dq, q)
+                if (F_ISSET(tsp, SC_SCRIPT) && sscr_paint(tsp, 1))
+                        return (1);
+        return (0);
+}
+
+/*
+ * sscr_wait --
+ *      Return the milliseconds until a scripting window is due a screen
+ *      update, or INFTIM if none is.
+ */
+static int
+sscr_wait(GS *gp)
+{
+        struct timespec ts;
+        SCR *tsp;
+        long ms;
+        int wait;
+
+        wait = INFTIM;
+        (void)clock_gettime(CLOCK_MONOTONIC, &ts);
+        TAILQ_FOREACH(tsp, &gp->dq, q) {
+                if (!F_ISSET(tsp, SC_SCRIPT) || !tsp->script->sh_stale)
+                        continue;
+                ms = (ts.tv_sec - tsp->script->sh_paint.tv_sec) * 1000 +
+                    (ts.tv_nsec - tsp->script->sh_paint.tv_nsec) / 1000000;
+                ms = ms < 0 || ms >= SSCR_PAINT ? 0 : SSCR_PAINT - ms;
+                if (wait == INFTIM || ms < wait)
+                        wait = ms;
+        }
+        return (wait);
 }
 
 /*
@@ -0,0 +1,368 @@
+/* SPDX-License-Identifier: BSD-3-Clause */
+
+/*
+ * Copyright (c) 2026 Jeffrey H. Johnson
+ *
+ * See the LICENSE.md file for redistribution information.
+ */
+
+#include <sys/types.h>
+#include <sys/queue.h>
+
+#include <bitstring.h>
+#include <ctype.h>
+#include <limits.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <bsd_stdlib.h>
+#include <bsd_string.h>
+
+#include "../common/common.h"
+
+/*
+ * A line being sorted.  The line is a copy, in the snapshot of the range
+ * taken before sorting, and its sort key is the part of it that follows,
+ * or with the r flag, that matches, the pattern.  The first bytes of the
+ * key are kept in pfx, so that most comparisons don't look at the lines.
+ */
+typedef struct {
+        size_t   off;                   /* Line offset in the snapshot. */
+        size_t   len;                   /* Line length. */
+        size_t   koff;                  /* Key offset in the line. */
+        size_t   klen;                  /* Key length. */
+        uint64_t pfx;                   /* First key bytes, big-endian. */
+        intmax_t num;                   /* Key number, with the n flag. */
+        recno_t  lno;                   /* Line number before the sort. */
+        int      haskey;                /* Pattern matched, number found. */
+} SLINE;
+
+typedef struct {
+        char    *text;                  /* Snapshot of the lines. */
+#define SORT_ICASE      0x01            /* i: Ignore case. */
+#define SORT_NUMERIC    0x02            /* n: Sort on the first number. */
+#define SORT_MATCH      0x04            /* r: Sort on the pattern match. */
+#define SORT_REVERSE    0x08            /* !: Reverse the order. */
+#define SORT_UNIQUE     0x10            /* u: Drop duplicate lines. */
+        unsigned int flags;
+} SORT;
+
+#define SORT_INSERTION  16              /* Insertion sort runs this short. */
+
+static int  sort_cmp(SORT *, SLINE *, SLINE *);
+static void sort_key(SORT *, SLINE *);
+static void sort_lines(SORT *, SLINE **, SLINE **, size_t);
+
+/*
+ * ex_sort -- :[line [,line]] sor[t][!] [inru] [/pattern/]
+ *      Sort lines.
+ *
+ * PUBLIC: int ex_sort(SCR *, EXCMD *);
+ */
+int
+ex_sort(SCR *sp, EXCMD *cmdp)
+{
+        SLINE *lines, **v, **tmp;
+        SORT s;
+        recno_t from, lno, to;
+        regmatch_t match[1];
+        size_t i, len, n, off, tlen;
+        int delim, eval, rval, usere;
+        CHAR_T *p, *ptrn, *t;
+        char *lp;
+
+        NEEDFILE(sp, cmdp);
+
+        memset(&s, 0, sizeof(s));
+        if (FL_ISSET(cmdp->iflags, E_C_FORCE))
+                s.flags |= SORT_REVERSE;
+
+        /* Parse the flags and the pattern. */
+        usere = 0;
+        for (p = cmdp->argc == 0 ? (CHAR_T *)"" : cmdp->argv[0]->bp;
+            *p != '\0';) {
+                if (isblank(*p)) {
+                        ++p;
+                        continue;
+                }
+                switch (*p) {
+                case 'i':
+                        s.flags |= SORT_ICASE;
+                        ++p;
+                        continue;
+                case 'n':
+                        s.flags |= SORT_NUMERIC;
+                        ++p;
+                        continue;
+                case 'r':
+                        s.flags |= SORT_MATCH;
+                        ++p;
+                        continue;
+                case 'u':
+                        s.flags |= SORT_UNIQUE;
+                        ++p;
+                        continue;
+                }
+                if (usere || isalnum(*p) ||
+                    *p == '\\' || *p == '|' || *p == '\n') {
+usage:                  ex_emsg(sp, cmdp->cmd->usage, EXM_USAGE);
+                        return (1);
+                }
+                usere = 1;
+
+                /*
+                 * Get the pattern string, toss escaped delimiters; see
+                 * ex_global.c.
+                 */
+                for (delim = *p++, ptrn = t = p;;) {
+                        if (p[0] == '\0' || p[0] == delim) {
+                                if (p[0] == delim)
+                                        ++p;
+                                *t = '\0';
+                                break;
+                        }
+                        if (p[0] == '\\') {
+                                if (p[1] == delim)
+                                        ++p;
+                                else if (p[1] == '\\')
+                                        *t++ = *p++;
+                        }
+                        *t++ = *p++;
+                }
+
+                /* If the pattern string is empty, use the last one. */
+                if (*ptrn == '\0') {
+                        if (sp->re == NULL) {
+                                ex_emsg(sp, NULL, EXM_NOPREVRE);
+                                return (1);
+                        }
+                        if (!F_ISSET(sp, SC_RE_SEARCH) &&
+                            re_compile(sp, sp->re, sp->re_len,
+                            NULL, NULL, &sp->re_c, RE_C_SEARCH))
+                                return (1);
+                } else if (re_compile(sp, ptrn, t - ptrn,
+                    &sp->re, &sp->re_len, &sp->re_c, RE_C_SEARCH))
+                        return (1);
+        }
+        if (F_ISSET(&s, SORT_MATCH) && !usere)
+                goto usage;
+
+        from = cmdp->addr1.lno;
+        to = cmdp->addr2.lno;
+        if (from == 0 || to <= from)
+                return (0);
+        n = to - from + 1;
+
+        /*
+         * Take a snapshot of the lines, find their keys, and sort pointers
+         * to them.  The sort is a merge sort, so lines with equal keys keep
+         * their order.
+         */
+        rval = 1;
+        s.text = NULL;
+        tlen = 0;
+        lines = NULL;
+        v = tmp = NULL;
+        CALLOC_GOTO(sp, lines, n, sizeof(SLINE));
+        CALLOC_GOTO(sp, v, n, sizeof(SLINE *));
+        CALLOC_GOTO(sp, tmp, (n + 1) / 2, sizeof(SLINE *));
+        for (off = 0, i = 0, lno = from; lno <= to; ++i, ++lno) {
+                if (db_get(sp, lno, DBG_FATAL, &lp, &len))
+                        goto err;
+                BINC_GOTO(sp, s.text, tlen, off + len);
+                if (len != 0)
+                        memcpy(s.text + off, lp, len);
+                lines[i].off = off;
+                lines[i].len = len;
+                lines[i].koff = 0;
+                lines[i].klen = len;
+                lines[i].lno = lno;
+                lines[i].haskey = 1;
+                off += len;
+        }
+        for (i = 0; i < n; ++i) {
+                if (usere) {
+                        match[0].rm_so = 0;
+                        match[0].rm_eo = lines[i].len;
+                        switch (eval = re_exec(sp, &sp->re_c,
+                            s.text + lines[i].off, 1, match, REG_STARTEND)) {
+                        case 0:
+                                if (F_ISSET(&s, SORT_MATCH)) {
+                                        lines[i].koff = match[0].rm_so;
+                                        lines[i].klen =
+                                            match[0].rm_eo - match[0].rm_so;
+                                } else {
+                                        lines[i].koff = match[0].rm_eo;
+                                        lines[i].klen =
+                                            lines[i].len - match[0].rm_eo;
+                                }
+                                break;
+                        case REG_NOMATCH:
+                                lines[i].haskey = 0;
+                                lines[i].klen = 0;
+                                break;
+                        default:
+                                re_error(sp, eval, &sp->re_c);
+                                goto err;
+                        }
+                }
+                sort_key(&s, &lines[i]);
+                v[i] = &lines[i];
+        }
+        sort_lines(&s, v, tmp, n);
+
+        /* With the u flag, keep the first of each run of equal lines. */
+        if (F_ISSET(&s, SORT_UNIQUE)) {
+                for (i = 1, len = 1; i < n; ++i)
+                        if (sort_cmp(&s, v[len - 1], v[i]) != 0)
+                                v[len++] = v[i];
+        } else
+                len = n;
+
+        /*
+         * Replace the lines that changed, and delete the ones that were
+         * dropped, from the end so the rest don't have to be renumbered.
+         * The log makes it a single change for undo.
+         */
+        for (i = 0, lno = from; i < len; ++i, ++lno) {
+                if (v[i]->lno == lno || (v[i]->len == lines[i].len &&
+                    memcmp(s.text + v[i]->off,
+                    s.text + lines[i].off, v[i]->len) == 0))
+                        continue;
+                if (db_set(sp, lno, s.text + v[i]->off, v[i]->len))
+                        goto err;
+                ++sp->rptlines[L_CHANGED];
+        }
+        for (lno = to; lno >= from + len; --lno) {
+                if (db_delete(sp, lno))
+                        goto err;
+                ++sp->rptlines[L_DELETED];
+        }
+
+        /* The cursor moves to the first line sorted. */
+        sp->lno = from;
+        sp->cno = 0;
+        (void)nonblank(sp, from, &sp->cno);
+        rval = 0;
+
+err:    free(s.text);
+        free(tmp);
+        free(v);
+        free(lines);
+        return (rval);
+
+alloc_err:
+        msgq(sp, M_SYSERR, NULL);
+        goto err;
+}
+
+/*
+ * sort_key --
+ *      Finish a line's sort key: find the number in it, or save the
+ *      leading bytes of it.
+ */
+static void
+sort_key(SORT *s, SLINE *lp)
+{
+        intmax_t num;
+        size_t i;
+        int neg;
+        unsigned char ch, *kp;
+
+        kp = (unsigned char *)s->text + lp->off + lp->koff;
+        if (F_ISSET(s, SORT_NUMERIC)) {
+                /*
+                 * The first decimal number in the key, including a leading
+                 * minus sign.  Lines without a number sort first.
+                 */
+                for (i = 0; i < lp->klen && !isdigit(kp[i]); ++i);
+                if (!lp->haskey || i == lp->klen) {
+                        lp->haskey = 0;
+                        return;
+                }
+                neg = i > 0 && kp[i - 1] == '-';
+                for (num = 0; i < lp->klen && isdigit(kp[i]); ++i)
+                        num = num > (INTMAX_MAX - 9) / 10 ?
+                            INTMAX_MAX : num * 10 + (kp[i] - '0');
+                lp->num = neg ? -num : num;
+                return;
+        }
+
+        lp->pfx = 0;
+        for (i = 0; i < sizeof(lp->pfx); ++i) {
+                ch = i < lp->klen ? kp[i] : 0;
+                if (F_ISSET(s, SORT_ICASE))
+                        ch = tolower(ch);
+                lp->pfx = lp->pfx << 8 | ch;
+        }
+}
+
+/*
+ * sort_cmp --
+ *      Compare two lines' sort keys.
+ */
+static int
+sort_cmp(SORT *s, SLINE *a, SLINE *b)
+{
+        size_t i, len;
+        int rval;
+        unsigned char *ap, *bp, ach, bch;
+
+        if (a->haskey != b->haskey)
+                rval = a->haskey - b->haskey;
+        else if (!a->haskey)
+                rval = 0;
+        else if (F_ISSET(s, SORT_NUMERIC))
+                rval = a->num < b->num ? -1 : a->num > b->num;
+        else if (a->pfx != b->pfx)
+                rval = a->pfx < b->pfx ? -1 : 1;
+        else {
+                ap = (unsigned char *)s->text + a->off + a->koff;
+                bp = (unsigned char *)s->text + b->off + b->koff;
+                len = a->klen < b->klen ? a->klen : b->klen;
+                rval = 0;
+                if (!F_ISSET(s, SORT_ICASE))
+                        rval = len == 0 ? 0 : memcmp(ap, bp, len);
+                else
+                        for (i = 0; i < len && rval == 0; ++i) {
+                                ach = tolower(ap[i]);
+                                bch = tolower(bp[i]);
+                                rval = ach - bch;
+                        }
+                if (rval == 0)
+                        rval = a->klen < b->klen ? -1 : a->klen > b->klen;
+        }
+        return (F_ISSET(s, SORT_REVERSE) ? -rval : rval);
+}
+
+/*
+ * sort_lines --
+ *      Merge sort an array of lines, using tmp for half of them.
+ */
+static void
+sort_lines(SORT *s, SLINE **v, SLINE **tmp, size_t n)
+{
+        SLINE *lp;
+        size_t h, i, j, k;
+
+        if (n <= SORT_INSERTION) {
+                for (i = 1; i < n; ++i) {
+                        lp = v[i];
+                        for (j = i; j > 0 && sort_cmp(s, v[j - 1], lp) > 0; --j)
+                                v[j] = v[j - 1];
+                        v[j] = lp;
+                }
+                return;
+        }
+
+        h = n / 2;
+        sort_lines(s, v, tmp, h);
+        sort_lines(s, v + h, tmp, n - h);
+        if (sort_cmp(s, v[h - 1], v[h]) <= 0)
+                return;
+
+        memcpy(tmp, v, h * sizeof(*v));
+        for (i = 0, j = h, k = 0; i < h && j < n;)
+                v[k++] = sort_cmp(s, tmp[i], v[j]) <= 0 ? tmp[i++] : v[j++];
+        while (i < h)
+                v[k++] = tmp[i++];
+}
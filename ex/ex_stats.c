@@ -0,0 +1,225 @@
+/* SPDX-License-Identifier: BSD-3-Clause */
+
+/*
+ * Copyright (c) 2026 Jeffrey H. Johnson
+ *
+ * See the LICENSE.md file for redistribution information.
+ */
+
+#include <sys/types.h>
+#include <sys/queue.h>
+
+#include <bitstring.h>
+#include <limits.h>
+#include <stdio.h>
+#include <bsd_stdlib.h>
+#include <bsd_string.h>
+#include <bsd_unistd.h>
+
+#include "../common/common.h"
+#include "../vi/vi.h"
+
+static void stats_file(EXF *, DBSTAT *, recno_t *, unsigned long long *);
+static void stats_fmt(GS *, EXF *, char *, size_t);
+
+/*
+ * ex_stats -- :stats[!]
+ *      Display the editor's performance counters, and with !, the slow
+ *      vi events remembered.
+ *
+ * PUBLIC: int ex_stats(SCR *, EXCMD *);
+ */
+int
+ex_stats(SCR *sp, EXCMD *cmdp)
+{
+        unsigned int n;
+        char buf[1024];
+
+        stats_fmt(sp->gp, sp->ep, buf, sizeof(buf));
+        (void)ex_puts(sp, buf);
+        if (FL_ISSET(cmdp->iflags, E_C_FORCE))
+                for (n = 0; !v_lat_slow(sp, n, buf, sizeof(buf)); ++n)
+                        (void)ex_puts(sp, buf);
+        return (0);
+}
+
+/*
+ * stats_signal --
+ *      Write the counters and the slow vi events, on request from outside
+ *      the editor: to the file VISTATS names, or if it doesn't name one,
+ *      to a new file in the temporary directory.  The latter is created by
+ *      mkstemp(3), so another user can't have it written through a link.
+ *
+ * PUBLIC: void stats_signal(SCR *);
+ */
+void
+stats_signal(SCR *sp)
+{
+        FILE *fp;
+        unsigned int n;
+        int fd;
+        char *p, *t, buf[1024], path[PATH_MAX];
+
+        if ((p = getenv("VISTATS")) != NULL && *p != '\0')
+                fp = fopen(p, "a");
+        else {
+                if ((t = getenv("TMPDIR")) == NULL || *t == '\0')
+                        t = "/tmp";
+                (void)snprintf(path, sizeof(path), "%s/vi.stats.%ld.XXXXXX",
+                    t, (long)getpid());
+                p = path;
+                if ((fd = mkstemp(path)) == -1)
+                        fp = NULL;
+                else if ((fp = fdopen(fd, "w")) == NULL) {
+                        (void)close(fd);
+                        (void)unlink(path);
+                }
+        }
+        if (fp == NULL) {
+                msgq_str(sp, M_SYSERR, p, "%s");
+                return;
+        }
+        stats_fmt(sp->gp, sp->ep, buf, sizeof(buf));
+        (void)fputs(buf, fp);
+        for (n = 0; !v_lat_slow(sp, n, buf, sizeof(buf)); ++n)
+                (void)fputs(buf, fp);
+        if (fclose(fp))
+                msgq_str(sp, M_SYSERR, p, "%s");
+        else
+                msgq_str(sp, M_INFO, p, "Statistics written to %s");
+}
+
+/*
+ * stats_fold --
+ *      Add the counters of a file that's being closed to the totals
+ *      written at exit.
+ *
+ * PUBLIC: void stats_fold(GS *, EXF *);
+ */
+void
+stats_fold(GS *gp, EXF *ep)
+{
+        if (F_ISSET(gp, G_STATS))
+                stats_file(ep, &gp->db_stat, &gp->log_recs, &gp->log_bytes);
+}
+
+/*
+ * stats_dump --
+ *      Write the counters at exit, if VISTATS is set: to the file it
+ *      names, or if it's empty, to the standard error output.
+ *
+ * PUBLIC: void stats_dump(GS *);
+ */
+void
+stats_dump(GS *gp)
+{
+        FILE *fp;
+        char *p, buf[1024];
+
+        if (!F_ISSET(gp, G_STATS) || (p = getenv("VISTATS")) == NULL)
+                return;
+        stats_fmt(gp, NULL, buf, sizeof(buf));
+        if (*p == '\0')
+                (void)fputs(buf, stderr);
+        else if ((fp = fopen(p, "a")) != NULL) {
+                (void)fputs(buf, fp);
+                (void)fclose(fp);
+        }
+}
+
+/*
+ * stats_file --
+ *      Add a file's buffer pool counters and undo log size to the totals.
+ */
+static void
+stats_file(EXF *ep, DBSTAT *stp, recno_t *recsp, unsigned long long *bytesp)
+{
+        DBSTAT st;
+        DBT data, key;
+        recno_t lno;
+
+        if (ep->db != NULL && dbstat(ep->db, &st) == 0) {
+                stp->cachehit += st.cachehit;
+                stp->cachemiss += st.cachemiss;
+                stp->pageread += st.pageread;
+                stp->pagewrite += st.pagewrite;
+                stp->zhit += st.zhit;
+                stp->zstore += st.zstore;
+        }
+
+        /* The records past the undo position are still kept for redo. */
+        if (ep->log == NULL)
+                return;
+        key.data = &lno;
+        key.size = sizeof(lno);
+        for (lno = 1; lno < ep->l_high; ++lno)
+                if (ep->log->get(ep->log, &key, &data, 0) == 0) {
+                        ++*recsp;
+                        *bytesp += data.size;
+                }
+}
+
+/*
+ * stats_fmt --
+ *      Format the counters, for the current file if there's one, and for
+ *      the files closed if not.
+ */
+static void
+stats_fmt(GS *gp, EXF *ep, char *bp, size_t blen)
+{
+        CB *cbp;
+        DBSTAT st;
+        TEXT *tp;
+        recno_t lrecs;
+        size_t len;
+        unsigned long cbufs, clines, cbytes, lookups;
+        unsigned long long lbytes;
+
+        if (ep == NULL) {
+                st = gp->db_stat;
+                lrecs = gp->log_recs;
+                lbytes = gp->log_bytes;
+        } else {
+                memset(&st, 0, sizeof(st));
+                lrecs = 0;
+                lbytes = 0;
+                stats_file(ep, &st, &lrecs, &lbytes);
+        }
+
+        cbufs = clines = cbytes = 0;
+        for (cbp = &gp->dcb_store; cbp != NULL;
+            cbp = cbp == &gp->dcb_store ?
+            LIST_FIRST(&gp->cutq) : LIST_NEXT(cbp, q)) {
+                if (TAILQ_EMPTY(&cbp->textq))
+                        continue;
+                ++cbufs;
+                TAILQ_FOREACH(tp, &cbp->textq, q) {
+                        ++clines;
+                        cbytes += sizeof(TEXT) + tp->lb_len;
+                }
+        }
+
+        lookups = gp->db_hits + gp->db_misses;
+        (void)snprintf(bp, blen,
+            "buffer pool: %lu hits, %lu misses, %lu reads, %lu writes\n"
+            "compressed pages: %lu stored, %lu reloaded\n"
+            "line cache: %lu hits, %lu misses, %lu%% hit\n"
+            "undo log: %lu records, %llu bytes\n"
+            "cut buffers: %lu buffers, %lu lines, %lu bytes\n"
+            "RE compiles: %lu, %lu cached, %.3f ms\n"
+            "RE executions: %lu, %.3f ms\n"
+            "recovery syncs: %lu, longest %.3f ms\n"
+            "screen output: %llu bytes\n",
+            st.cachehit, st.cachemiss, st.pageread, st.pagewrite,
+            st.zstore, st.zhit,
+            gp->db_hits, gp->db_misses,
+            lookups == 0 ? 0 : (unsigned long)(gp->db_hits * 100.0 / lookups),
+            (unsigned long)lrecs, lbytes,
+            cbufs, clines, cbytes,
+            gp->re_misses, gp->re_hits, gp->re_cnsec / 1e6,
+            gp->re_execs, gp->re_ensec / 1e6,
+            gp->rcv_syncs, gp->rcv_nsec / 1e6,
+            gp->scr_bytes);
+        if ((len = strlen(bp)) < blen)
+                v_lat_fmt(gp, bp + len, blen - len);
+}
@@ -32,9 +32,44 @@
 #define SUB_FIRST       0x01            /* The 'r' flag isn't reasonable. */
 #define SUB_MUSTSETR    0x02            /* The 'r' flag is required.      */
 
+/* Case conversions done by the replacement. */
+enum subconv { CV_NONE, CV_LOWER, CV_ONELOWER, CV_ONEUPPER, CV_UPPER };
+
+/*
+ * The replacement string, compiled by re_tmpl into a list of operations,
+ * so that re_sub doesn't parse it again for every match.
+ */
+typedef struct {
+        enum { SO_CONV, SO_LIT, SO_MATCH, SO_NL } op;
+        size_t off;                     /* SO_LIT, SO_NL: replacement offset. */
+        size_t arg;                     /* Length, subexpression, conversion. */
+} SUBOP;
+
+/*
+ * Compiled REs are shared by the screens' search and substitute REs, and
+ * kept for a while after they're replaced, so compiling a pattern again,
+ * e.g., for every line of :g/x/s/a/b/, usually doesn't call regcomp.  They
+ * are looked up by the converted pattern and the regcomp flags, which hold
+ * the effects of the magic, extended, ignorecase and iclower options.
+ */
+typedef struct _recache {
+        TAILQ_ENTRY(_recache) q;        /* Linked list of compiled REs. */
+        char    *ptrn;                  /* Converted pattern. */
+        size_t   len;                   /* Converted pattern length. */
+        int      reflags;               /* Regcomp flags. */
+        int      refs;                  /* Screen REs using it. */
+        regex_t  re;                    /* Compiled RE. */
+} RECACHE;
+
+#define RE_CACHE        8               /* Unused compiled REs kept. */
+
+static int re_cache(SCR *, char *, size_t, int, regex_t *, unsigned int);
+static void re_cache_trim(GS *);
 static int re_conv(SCR *, char **, size_t *, int *);
-static int re_sub(SCR *, char *, char **, size_t *, size_t *, regmatch_t [10]);
+static int re_sub(SCR *, char *, char **, size_t *, size_t *, regmatch_t [10],
+    SUBOP *, size_t);
 static int re_tag_conv(SCR *, char **, size_t *, int *);
+static int re_tmpl(SCR *, SUBOP **, size_t *);
 static int s(SCR *, EXCMD *, char *, regex_t *, unsigned int);
 
 /*
@@ -339,11 +374,12 @@ s(SCR *sp, EXCMD *cmdp, char *s, regex_t *re, unsigned int flags)
 {
         EVENT ev;
         MARK from, to;
+        SUBOP *ops;
         TEXTH tiq;
         recno_t elno, lno, slno;
         regmatch_t match[10];
         size_t blen, cnt, last, lbclen, lblen, len, llen;
-        size_t offset, saved_offset, scno;
+        size_t nops, offset, saved_offset, scno;
         int lflag, nflag, pflag, rflag;
         int didsub, do_eol_match, eflags, nempty, eval;
         int linechanged, matched, quit, rval;
@@ -482,12 +518,20 @@ noargs: if (F_ISSET(sp, SC_VI) && sp->c_suffix && (lflag || nflag || pflag)) {
         bp = lb = NULL;
         blen = lbclen = lblen = 0;
 
+        /* Compile the replacement string. */
+        if (re_tmpl(sp, &ops, &nops))
+                return (1);
+
         /* For each line... */
         for (matched = quit = 0, lno = cmdp->addr1.lno,
             elno = cmdp->addr2.lno; !quit && lno <= elno; ++lno) {
 
-                /* Someone's unhappy, time to stop. */
-                if (INTERRUPTED(sp))
+                /*
+                 * Someone's unhappy, time to stop.  Only poll for an
+                 * interrupt every INTERRUPT_CHECK lines.
+                 */
+                if (F_ISSET(sp->gp, G_INTERRUPTED) ||
+                    (lno % INTERRUPT_CHECK == 0 && INTERRUPTED(sp)))
                         break;
 
                 /* Get the line. */
@@ -537,7 +581,7 @@ nextmatch:      match[0].rm_so = offset;
                 match[0].rm_eo = llen;
 
                 /* Get the next match. */
-                eval = regexec(re, (char *)s, 10, match, eflags);
+                eval = re_exec(sp, re, (char *)s, 10, match, eflags);
 
                 /*
                  * There wasn't a match or if there was an error, deal with
@@ -678,7 +722,7 @@ lquit:                          quit = 1;
 
                 /* Substitute the matching bytes. */
                 didsub = 1;
-                if (re_sub(sp, s, &lb, &lbclen, &lblen, match))
+                if (re_sub(sp, s, &lb, &lbclen, &lblen, match, ops, nops))
                         goto err;
 
                 /* Set the change flag so we know this line was modified. */
@@ -860,6 +904,7 @@ err:            rval = 1;
         if (bp != NULL)
                 FREE_SPACE(sp, bp, blen);
         free(lb);
+        free(ops);
         return (rval);
 }
 
@@ -875,7 +920,7 @@ re_compile(SCR *sp, char *ptrn, size_t plen, char **ptrnp, size_t *lenp,
     regex_t *rep, unsigned int flags)
 {
         size_t len;
-        int reflags, replaced, rval;
+        int reflags, replaced;
         char *p;
 
         /* Set RE flags. */
@@ -894,13 +939,13 @@ re_compile(SCR *sp, char *ptrn, size_t plen, char **ptrnp, size_t *lenp,
                 }
         }
 
-        /* If we're replacing a saved value, clear the old one. */
+        /* If we're replacing a saved value, release the old one. */
         if (LF_ISSET(RE_C_SEARCH) && F_ISSET(sp, SC_RE_SEARCH)) {
-                regfree(&sp->re_c);
+                re_release(sp, &sp->re_c);
                 F_CLR(sp, SC_RE_SEARCH);
         }
         if (LF_ISSET(RE_C_SUBST) && F_ISSET(sp, SC_RE_SUBST)) {
-                regfree(&sp->subre_c);
+                re_release(sp, &sp->subre_c);
                 F_CLR(sp, SC_RE_SUBST);
         }
 
@@ -946,16 +991,8 @@ re_compile(SCR *sp, char *ptrn, size_t plen, char **ptrnp, size_t *lenp,
                 ptrn = *ptrnp;
         }
 
-        /*
-         * XXX
-         * Regcomp isn't 8-bit clean, so we just lost if the pattern
-         * contained a NULL.  Bummer!
-         */
-        if ((rval = regcomp(rep, ptrn, /* plen, */ reflags)) != 0) {
-                if (!LF_ISSET(RE_C_SILENT))
-                        re_error(sp, rval, rep);
+        if (re_cache(sp, ptrn, plen, reflags, rep, flags))
                 return (1);
-        }
 
         if (LF_ISSET(RE_C_SEARCH))
                 F_SET(sp, SC_RE_SEARCH);
@@ -965,6 +1002,122 @@ re_compile(SCR *sp, char *ptrn, size_t plen, char **ptrnp, size_t *lenp,
         return (0);
 }
 
+/*
+ * re_cache --
+ *      Find or compile a converted pattern.
+ */
+static int
+re_cache(SCR *sp, char *ptrn, size_t plen, int reflags, regex_t *rep,
+    unsigned int flags)
+{
+        GS *gp;
+        RECACHE *rcp;
+        unsigned long long ns;
+        int rval;
+
+        gp = sp->gp;
+        TAILQ_FOREACH(rcp, &gp->rech, q)
+                if (rcp->reflags == reflags && rcp->len == plen &&
+                    memcmp(rcp->ptrn, ptrn, plen) == 0)
+                        break;
+        if (rcp != NULL) {
+                ++gp->re_hits;
+                TAILQ_REMOVE(&gp->rech, rcp, q);
+        } else {
+                ++gp->re_misses;
+                CALLOC_RET(sp, rcp, 1, sizeof(RECACHE));
+                MALLOC(sp, rcp->ptrn, plen + 1);
+                if (rcp->ptrn == NULL) {
+                        free(rcp);
+                        return (1);
+                }
+                memcpy(rcp->ptrn, ptrn, plen);
+                rcp->ptrn[plen] = '\0';
+                rcp->len = plen;
+                rcp->reflags = reflags;
+
+                /*
+                 * XXX
+                 * Regcomp isn't 8-bit clean, so we just lost if the pattern
+                 * contained a NULL.  Bummer!
+                 */
+                ns = nsec_now();
+                rval = regcomp(&rcp->re, rcp->ptrn, /* plen, */ reflags);
+                gp->re_cnsec += nsec_now() - ns;
+                if (rval != 0) {
+                        if (!LF_ISSET(RE_C_SILENT))
+                                re_error(sp, rval, &rcp->re);
+                        free(rcp->ptrn);
+                        free(rcp);
+                        return (1);
+                }
+        }
+        TAILQ_INSERT_HEAD(&gp->rech, rcp, q);
+        ++rcp->refs;
+        *rep = rcp->re;
+        re_cache_trim(gp);
+        return (0);
+}
+
+/*
+ * re_release --
+ *      Release a screen's compiled RE.
+ *
+ * PUBLIC: void re_release(SCR *, regex_t *);
+ */
+void
+re_release(SCR *sp, regex_t *rep)
+{
+        RECACHE *rcp;
+
+        TAILQ_FOREACH(rcp, &sp->gp->rech, q)
+                if (rcp->re.re_g == rep->re_g) {
+                        --rcp->refs;
+                        break;
+                }
+        re_cache_trim(sp->gp);
+}
+
+/*
+ * re_cache_trim --
+ *      Discard the least recently used compiled REs that aren't in use.
+ */
+static void
+re_cache_trim(GS *gp)
+{
+        RECACHE *next, *rcp;
+        int unused;
+
+        for (unused = 0, rcp = TAILQ_FIRST(&gp->rech); rcp != NULL; rcp = next) {
+                next = TAILQ_NEXT(rcp, q);
+                if (rcp->refs != 0 || ++unused <= RE_CACHE)
+                        continue;
+                TAILQ_REMOVE(&gp->rech, rcp, q);
+                regfree(&rcp->re);
+                free(rcp->ptrn);
+                free(rcp);
+        }
+}
+
+/*
+ * re_cache_end --
+ *      Discard the compiled REs.
+ *
+ * PUBLIC: void re_cache_end(GS *);
+ */
+void
+re_cache_end(GS *gp)
+{
+        RECACHE *rcp;
+
+        while ((rcp = TAILQ_FIRST(&gp->rech)) != NULL) {
+                TAILQ_REMOVE(&gp->rech, rcp, q);
+                regfree(&rcp->re);
+                free(rcp->ptrn);
+                free(rcp);
+        }
+}
+
 /*
  * re_conv --
  *      Convert vi's regular expressions into something that the
@@ -1200,26 +1353,45 @@ re_error(SCR *sp, int errcode, regex_t *preg)
 }
 
 /*
- * re_sub --
- *      Do the substitution for a regular expression.
+ * re_exec --
+ *      Execute a compiled RE, counting the executions and their time.
+ *
+ * PUBLIC: int re_exec(SCR *, regex_t *, const char *, size_t,
+ * PUBLIC:     regmatch_t *, int);
  */
-static int
-re_sub(SCR *sp, char *ip, char **lbp, size_t *lbclenp, size_t *lblenp,
-    regmatch_t match[10])
+int
+re_exec(SCR *sp, regex_t *rep, const char *str, size_t nmatch,
+    regmatch_t *match, int eflags)
 {
-        enum { C_NOTSET, C_LOWER, C_ONELOWER, C_ONEUPPER, C_UPPER } conv;
-        size_t lbclen, lblen;           /* Local copies. */
-        size_t mlen;                    /* Match length. */
-        size_t rpl;                     /* Remaining replacement length. */
-        char *rp;                       /* Replacement pointer. */
-        int ch;
-        int no;                         /* Match replacement offset. */
-        char *p, *t;                    /* Buffer pointers. */
-        char *lb;                       /* Local copies. */
+        GS *gp;
+        unsigned long long ns;
+        int eval;
+
+        gp = sp->gp;
+        ns = nsec_now();
+        eval = regexec(rep, str, nmatch, match, eflags);
+        gp->re_ensec += nsec_now() - ns;
+        ++gp->re_execs;
+        return (eval);
+}
 
-        lb = *lbp;                      /* Get local copies. */
-        lbclen = *lbclenp;
-        lblen = *lblenp;
+/*
+ * re_tmpl --
+ *      Compile the replacement string into a list of operations: runs of
+ *      literal characters, newlines, subexpressions and case conversions.
+ */
+static int
+re_tmpl(SCR *sp, SUBOP **opsp, size_t *nopsp)
+{
+        SUBOP *lit, *ops;
+        size_t nops, off, rpl;
+        char *rp;
+        int no;
+
+        *opsp = NULL;
+        *nopsp = 0;
+        if (sp->repl_len == 0)
+                return (0);
 
         /*
          * QUOTING NOTE:
@@ -1237,40 +1409,19 @@ re_sub(SCR *sp, char *ip, char **lbp, size_t *lbclenp, size_t *lblenp,
          *
          * Otherwise, since this is the lowest level of replacement, discard
          * all escaping characters.  This (hopefully) matches historic practice.
+         *
+         * There's at most one operation for each character.
          */
-#define OUTCH(ch, nltrans) {                                            \
-        CHAR_T __ch = (ch);                                             \
-        unsigned int __value = KEY_VAL(sp, __ch);                       \
-        if ((nltrans) && (__value == K_CR || __value == K_NL)) {        \
-                NEEDNEWLINE(sp);                                        \
-                sp->newl[sp->newl_cnt++] = lbclen;                      \
-        } else if (conv != C_NOTSET) {                                  \
-                switch (conv) {                                         \
-                case C_ONELOWER:                                        \
-                        conv = C_NOTSET;                                \
-                        /* FALLTHROUGH */                               \
-                case C_LOWER:                                           \
-                        if (isupper(__ch))                              \
-                                __ch = tolower(__ch);                   \
-                        break;                                          \
-                case C_ONEUPPER:                                        \
-                        conv = C_NOTSET;                                \
-                        /* FALLTHROUGH */                               \
-                case C_UPPER:                                           \
-                        if (islower(__ch))                              \
-                                __ch = toupper(__ch);                   \
-                        break;                                          \
-                default:                                                \
-                        abort();                                        \
-                }                                                       \
-        }                                                               \
-        NEEDSP(sp, 1, p);                                               \
-        *p++ = __ch;                                                    \
-        ++lbclen;                                                       \
+#define ADDOP(o, a) {                                                   \
+        ops[nops].op = (o);                                             \
+        ops[nops].off = rp - 1 - sp->repl;                              \
+        ops[nops++].arg = (a);                                          \
+        lit = NULL;                                                     \
 }
-        conv = C_NOTSET;
-        for (rp = sp->repl, rpl = sp->repl_len, p = lb + lbclen; rpl--;) {
-                switch (ch = *rp++) {
+        CALLOC_RET(sp, ops, sp->repl_len, sizeof(SUBOP));
+        for (nops = 0, lit = NULL,
+            rp = sp->repl, rpl = sp->repl_len; rpl--;) {
+                switch (*rp++) {
                 case '&':
                         if (O_ISSET(sp, O_MAGIC)) {
                                 no = 0;
@@ -1281,7 +1432,7 @@ re_sub(SCR *sp, char *ip, char **lbp, size_t *lbclenp, size_t *lblenp,
                         if (rpl == 0)
                                 break;
                         --rpl;
-                        switch (ch = *rp) {
+                        switch (*rp) {
                         case '&':
                                 ++rp;
                                 if (!O_ISSET(sp, O_MAGIC)) {
@@ -1292,40 +1443,148 @@ re_sub(SCR *sp, char *ip, char **lbp, size_t *lbclenp, size_t *lblenp,
                         case '0': case '1': case '2': case '3': case '4':
                         case '5': case '6': case '7': case '8': case '9':
                                 no = *rp++ - '0';
-subzero:                        if (match[no].rm_so == -1 ||
-                                    match[no].rm_eo == -1)
-                                        break;
-                                mlen = match[no].rm_eo - match[no].rm_so;
-                                for (t = ip + match[no].rm_so; mlen--; ++t)
-                                        OUTCH(*t, 0);
+subzero:                        ADDOP(SO_MATCH, no);
                                 continue;
                         case 'e':
                         case 'E':
                                 ++rp;
-                                conv = C_NOTSET;
+                                ADDOP(SO_CONV, CV_NONE);
                                 continue;
                         case 'l':
                                 ++rp;
-                                conv = C_ONELOWER;
+                                ADDOP(SO_CONV, CV_ONELOWER);
                                 continue;
                         case 'L':
                                 ++rp;
-                                conv = C_LOWER;
+                                ADDOP(SO_CONV, CV_LOWER);
                                 continue;
                         case 'u':
                                 ++rp;
-                                conv = C_ONEUPPER;
+                                ADDOP(SO_CONV, CV_ONEUPPER);
                                 continue;
                         case 'U':
                                 ++rp;
-                                conv = C_UPPER;
+                                ADDOP(SO_CONV, CV_UPPER);
                                 continue;
                         default:
                                 ++rp;
                                 break;
                         }
                 }
-                OUTCH(ch, 1);
+
+                /*
+                 * A literal character, the one before rp.  Newlines split
+                 * the line, anything else extends the current run.
+                 */
+                off = rp - 1 - sp->repl;
+                switch (KEY_VAL(sp, (CHAR_T)rp[-1])) {
+                case K_CR:
+                case K_NL:
+                        ADDOP(SO_NL, 0);
+                        break;
+                default:
+                        if (lit != NULL && lit->off + lit->arg == off)
+                                ++lit->arg;
+                        else {
+                                ADDOP(SO_LIT, 1);
+                                lit = &ops[nops - 1];
+                        }
+                        break;
+                }
+        }
+#undef ADDOP
+
+        *opsp = ops;
+        *nopsp = nops;
+        return (0);
+}
+
+/*
+ * re_sub --
+ *      Do the substitution for a regular expression, from the compiled
+ *      replacement string.
+ */
+static int
+re_sub(SCR *sp, char *ip, char **lbp, size_t *lbclenp, size_t *lblenp,
+    regmatch_t match[10], SUBOP *ops, size_t nops)
+{
+        enum subconv conv;
+        SUBOP *eop, *op;
+        size_t lbclen, lblen;           /* Local copies. */
+        size_t len;                     /* Copy length. */
+        CHAR_T ch;
+        char *p, *t;                    /* Buffer pointers. */
+        char *lb;                       /* Local copies. */
+
+        lb = *lbp;                      /* Get local copies. */
+        lbclen = *lbclenp;
+        lblen = *lblenp;
+
+        conv = CV_NONE;
+        for (p = lb + lbclen, op = ops, eop = ops + nops; op < eop; ++op) {
+                switch (op->op) {
+                case SO_CONV:
+                        conv = op->arg;
+                        continue;
+                case SO_NL:
+                        NEEDNEWLINE(sp);
+                        sp->newl[sp->newl_cnt++] = lbclen;
+                        NEEDSP(sp, 1, p);
+                        *p++ = sp->repl[op->off];
+                        ++lbclen;
+                        continue;
+                case SO_LIT:
+                        t = sp->repl + op->off;
+                        len = op->arg;
+                        break;
+                case SO_MATCH:
+                        /* An unmatched subexpression is copied as its digit. */
+                        if (match[op->arg].rm_so == -1 ||
+                            match[op->arg].rm_eo == -1) {
+                                t = sp->repl + op->off;
+                                len = 1;
+                        } else {
+                                t = ip + match[op->arg].rm_so;
+                                len = match[op->arg].rm_eo -
+                                    match[op->arg].rm_so;
+                        }
+                        break;
+                default:
+                        abort();
+                }
+                if (len == 0)
+                        continue;
+                NEEDSP(sp, len, p);
+                lbclen += len;
+
+                /* Only case conversions are done a character at a time. */
+                switch (conv) {
+                case CV_NONE:
+                        memcpy(p, t, len);
+                        p += len;
+                        continue;
+                case CV_ONELOWER:
+                case CV_ONEUPPER:
+                        ch = *t++;
+                        if (conv == CV_ONELOWER ? isupper(ch) : islower(ch))
+                                ch = conv == CV_ONELOWER ?
+                                    tolower(ch) : toupper(ch);
+                        *p++ = ch;
+                        conv = CV_NONE;
+                        memcpy(p, t, --len);
+                        p += len;
+                        continue;
+                case CV_LOWER:
+                        for (; len--; *p++ = ch)
+                                if (isupper(ch = *t++))
+                                        ch = tolower(ch);
+                        continue;
+                case CV_UPPER:
+                        for (; len--; *p++ = ch)
+                                if (islower(ch = *t++))
+                                        ch = toupper(ch);
+                        continue;
+                }
         }
 
         *lbp = lb;                      /* Update caller's information. */
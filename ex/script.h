@@ -23,4 +23,6 @@ struct _script {
         char     sh_name[64];           /* Pty name              */
         struct   winsize sh_win;        /* Window size.          */
         struct   termios sh_term;       /* Terminal information. */
+        struct   timespec sh_paint;     /* Last screen update.   */
+        int      sh_stale;              /* Screen needs update.  */
 };
@@ -135,6 +135,7 @@ typedef struct {
         size_t          (*prefix)       /* prefix function       */
                             (const DBT *, const DBT *); /* ...   */
         int             lorder;         /* byte order            */
+        unsigned int    zcachesize;     /* compressed page bytes */
 } BTREEINFO;
 
 # define HASHMAGIC      0x061561
@@ -165,7 +166,19 @@ typedef struct {
         unsigned char   bval;           /* delimiting byte           */
                                         /* (variable-length records) */
         char    *bfname;                /* btree file name           */
+        unsigned int    zcachesize;     /* compressed page bytes     */
 } RECNOINFO;
 
+/* Buffer pool counters, returned by dbstat. */
+typedef struct {
+        unsigned long   cachehit;       /* pages found in the pool   */
+        unsigned long   cachemiss;      /* pages not in the pool     */
+        unsigned long   pageread;       /* pages read from the file  */
+        unsigned long   pagewrite;      /* pages written to the file */
+        unsigned long   zhit;           /* compressed pages reloaded */
+        unsigned long   zstore;         /* pages compressed          */
+} DBSTAT;
+
 DB *dbopen(const char *, int, int, DBTYPE, const void *);
+int dbstat(const DB *, DBSTAT *);
 #endif /* !_DB_H_ */
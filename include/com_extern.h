@@ -37,6 +37,7 @@ int cut(SCR *, CHAR_T *, MARK *, MARK *, int);
 int cut_line(SCR *, recno_t, size_t, size_t, CB *);
 void cut_close(GS *);
 TEXT *text_init(SCR *, const char *, size_t, size_t);
+void text_gapclose(TEXT *);
 void text_lfree(TEXTH *);
 void text_free(TEXT *);
 int del(SCR *, MARK *, MARK *, int);
@@ -61,14 +62,20 @@ void v_event_err(SCR *, EVENT *);
 int v_event_flush(SCR *, unsigned int);
 int db_eget(SCR *, recno_t, char **, size_t *, int *);
 int db_get(SCR *, recno_t, u_int32_t, char **, size_t *);
+int db_gget(SCR *,
+recno_t, u_int32_t, char **, size_t *, size_t *, size_t *);
 int db_delete(SCR *, recno_t);
 int db_append(SCR *, int, recno_t, char *, size_t);
 int db_insert(SCR *, recno_t, char *, size_t);
 int db_set(SCR *, recno_t, char *, size_t);
 int db_exist(SCR *, recno_t);
 int db_last(SCR *, recno_t *);
+int db_last_est(SCR *, recno_t *, int *);
+int db_snapshot(SCR *);
 int db_cache_update(SCR *, EXF *, recno_t, void *, size_t);
 void db_err(SCR *, recno_t);
+int db_mmap(SCR *, EXF *, int);
+void db_munmap(SCR *, EXF *);
 int log_init(SCR *, EXF *);
 int log_end(SCR *, EXF *);
 int log_cursor(SCR *);
@@ -79,6 +86,7 @@ int log_setline(SCR *);
 int log_forward(SCR *, MARK *);
 int editor(GS *, int, char *[]);
 void v_end(GS *);
+void v_phase(GS *, const char *);
 int mark_init(SCR *, EXF *);
 int mark_end(SCR *, EXF *);
 int mark_get(SCR *, CHAR_T, MARK *, mtype_t);
@@ -142,4 +150,5 @@ int nonblank(SCR *, recno_t, size_t *);
 CHAR_T *v_strdup(SCR *, const CHAR_T *, size_t);
 enum nresult nget_uslong(unsigned long *, const char *, char **, int);
 enum nresult nget_slong(long *, const char *, char **, int);
+unsigned long long nsec_now(void);
 void TRACE(SCR *, const char *, ...);
@@ -87,5 +87,6 @@ u_int32_t       __default_hash(const void *, size_t);
 __END_HIDDEN_DECLS
 
 PROTO_NORMAL(dbopen);
+PROTO_NORMAL(dbstat);
 
 #endif /* !_LIBC_DB_H_ */
@@ -111,6 +111,11 @@ int ex_exec_proc(SCR *, EXCMD *, char *, const char *, int);
 int proc_wait(SCR *, pid_t, const char *, int, int);
 int ex_shiftl(SCR *, EXCMD *);
 int ex_shiftr(SCR *, EXCMD *);
+int ex_sort(SCR *, EXCMD *);
+int ex_stats(SCR *, EXCMD *);
+void stats_signal(SCR *);
+void stats_fold(GS *, EXF *);
+void stats_dump(GS *);
 int ex_source(SCR *, EXCMD *);
 int ex_sourcefd(SCR *, EXCMD *, int);
 int ex_stop(SCR *, EXCMD *);
@@ -119,6 +124,9 @@ int ex_subagain(SCR *, EXCMD *);
 int ex_subtilde(SCR *, EXCMD *);
 int re_compile(SCR *, char *, size_t, char **, size_t *, regex_t *, unsigned int);
 void re_error(SCR *, int, regex_t *);
+int re_exec(SCR *, regex_t *, const char *, size_t, regmatch_t *, int);
+void re_release(SCR *, regex_t *);
+void re_cache_end(GS *);
 int ex_tag_first(SCR *, char *);
 int ex_tag_push(SCR *, EXCMD *);
 int ex_tag_next(SCR *, EXCMD *);
@@ -68,6 +68,23 @@ typedef struct _bkt {
         u_int8_t flags;                 /* flags                      */
 } BKT;
 
+/*
+ * Pages pushed off the end of the lru chain may optionally be kept in a
+ * second, compressed, tier instead of being written to (and later re-read
+ * from) the backing file.  The ZBKT structures are threaded on their own
+ * hash and lru chains, and the tier is bounded by a byte budget.  A dirty
+ * page in the compressed tier is only written to the file when it ages out
+ * of the tier or the pool is synced.
+ */
+typedef struct _zbkt {
+        TAILQ_ENTRY(_zbkt) hq;          /* hash queue                 */
+        TAILQ_ENTRY(_zbkt) q;           /* lru queue                  */
+        pgno_t   pgno;                  /* page number                */
+        u_int32_t len;                  /* compressed length          */
+        u_int8_t flags;                 /* MPOOL_DIRTY                */
+        unsigned char data[1];          /* compressed page image      */
+} ZBKT;
+
 typedef struct MPOOL {
         TAILQ_HEAD(_lqh, _bkt) lqh;     /* lru queue head                  */
                                         /* hash queue array                */
@@ -82,7 +99,13 @@ typedef struct MPOOL {
                                         /* page out conversion routine     */
         void    (*pgout)(void *, pgno_t, void *); /* ...                   */
         void    *pgcookie;              /* cookie for page in/out routines */
-# ifdef STATISTICS
+                                        /* compressed tier lru queue       */
+        TAILQ_HEAD(_zlqh, _zbkt) zlqh;  /* ...                             */
+                                        /* compressed tier hash queues     */
+        TAILQ_HEAD(_zhqh, _zbkt) zhqh[HASHSIZE]; /* ...                    */
+        unsigned long   zbytes;         /* bytes in the compressed tier    */
+        unsigned long   zmax;           /* compressed tier budget, 0 = off */
+        void    *zpage;                 /* compression scratch page        */
         unsigned long   cachehit;
         unsigned long   cachemiss;
         unsigned long   pagealloc;
@@ -92,7 +115,10 @@ typedef struct MPOOL {
         unsigned long   pageput;
         unsigned long   pageread;
         unsigned long   pagewrite;
-# endif /* ifdef STATISTICS */
+        unsigned long   zhit;
+        unsigned long   zstore;
+        unsigned long   zreject;
+        unsigned long   zevict;
 } MPOOL;
 
 # define MPOOL_IGNOREPIN     0x01       /* Ignore if the page is pinned.    */
@@ -109,6 +135,7 @@ int      mpool_delete(MPOOL *, void *);
 int      mpool_put(MPOOL *, void *, unsigned int);
 int      mpool_sync(MPOOL *);
 int      mpool_close(MPOOL *);
+int      mpool_zcache(MPOOL *, unsigned long);
 
 PROTO_NORMAL(mpool_open);
 PROTO_NORMAL(mpool_filter);
@@ -118,6 +145,7 @@ PROTO_NORMAL(mpool_delete);
 PROTO_NORMAL(mpool_put);
 PROTO_NORMAL(mpool_sync);
 PROTO_NORMAL(mpool_close);
+PROTO_NORMAL(mpool_zcache);
 
 # ifdef STATISTICS
 void     mpool_stat(MPOOL *);
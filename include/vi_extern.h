@@ -144,8 +144,14 @@ int v_z(SCR *, VICMD *);
 int vs_crel(SCR *, long);
 int v_zexit(SCR *, VICMD *);
 int vi(SCR **);
+void v_lat_key(SCR *, EVENT *);
+void v_lat_paint(SCR *);
+void v_lat_fmt(GS *, char *, size_t);
+int v_lat_slow(SCR *, unsigned int, char *, size_t);
 int vs_line(SCR *, SMAP *, size_t *, size_t *);
 int vs_number(SCR *);
+void vs_row_change(SCR *, recno_t, lnop_t);
+void vs_row_scroll(SCR *, size_t, int);
 void vs_busy(SCR *, const char *, busy_t);
 void vs_home(SCR *);
 void vs_update(SCR *, const char *, const char *);
@@ -139,6 +139,25 @@ CHIN(const cset *cs, char c)
   return ( cs->ptr[(uch)c] & cs->mask ) != 0;
 }
 
+/*
+ * Lazily built DFA for the small matcher's fast() and slow() scans of the
+ * whole RE.  Its states are the state sets the scans reach, and for each
+ * scan, its transitions, on classes of characters that every operator in
+ * the strip treats alike, are found by step() the first time they're taken.
+ * Once DFASETS sets are known, new ones aren't kept, and their transitions
+ * go back to step().
+ */
+#define DFASETS 256     /* most cached state sets */
+struct re_dfa
+{
+  int nclass;                  /* number of character classes */
+  uch class[NC];               /* character -> class */
+  int nsets;                   /* number of cached state sets */
+  long sets[DFASETS];          /* cached state sets */
+  short hash[DFASETS * 2];     /* state set hash -> set number + 1 */
+  short *trans;                /* [2][DFASETS][nclass] -> set, or -1 */
+};
+
 /*
  * main compiled-expression structure
  */
@@ -159,6 +178,7 @@ struct re_guts
 #define USEBOL 01   /* used ^ */
 #define USEEOL 02   /* used $ */
 #define BAD    04   /* something wrong */
+#define NODFA  010  /* fast() can't use a DFA */
   int nbol;         /* number of ^ used */
   int neol;         /* number of $ used */
   char *must;       /* match must contain this string */
@@ -166,6 +186,12 @@ struct re_guts
   size_t nsub;      /* copy of re_nsub */
   int backrefs;     /* does it use back references? */
   sopno nplus;      /* how deep does it nest +s? */
+  /* matcher scratch space, allocated on first use and kept until regfree */
+  regmatch_t *pmatch;    /* [nsub+1] */
+  const char **lastpos;  /* [nplus+1] */
+  char *space;           /* large state sets */
+  unsigned long *mspace; /* medium state sets */
+  struct re_dfa *dfa;    /* small matcher's DFA */
 };
 
 /* misc utilities */
@@ -74,6 +74,18 @@
 # define match lmat
 # define nope lnope
 #endif /* ifdef LNAMES */
+#ifdef MNAMES
+# define matcher mmatcher
+# define fast mfast
+# define slow mslow
+# define dissect mdissect
+# define backref mbackref
+# define step mstep
+# define print mprint
+# define at mat
+# define match mmat
+# define nope mnope
+#endif /* ifdef MNAMES */
 
 /* another structure passed up and down to avoid zillions of parameters */
 struct match
@@ -103,6 +115,14 @@ static const char *fast(struct match *, const char *, const char *, sopno,
 static const char *slow(struct match *, const char *, const char *, sopno,
                         sopno);
 static states step(struct re_guts *, sopno, sopno, states, int, states);
+#ifdef SNAMES
+static struct re_dfa *dfa_init(struct re_guts *);
+static int dfa_set(struct re_dfa *, long);
+static const char *dfast(struct match *, const char *, const char *, sopno,
+                         sopno);
+static const char *dslow(struct match *, const char *, const char *, sopno,
+                         sopno);
+#endif /* ifdef SNAMES */
 
 #define MAX_RECURSION 100
 #define BOL ( OUT + 1 )
@@ -205,8 +225,8 @@ matcher(struct re_guts *g, const char *string, size_t nmatch,
   /* match struct setup */
   m->g = g;
   m->eflags = eflags;
-  m->pmatch = NULL;
-  m->lastpos = NULL;
+  m->pmatch = g->pmatch;
+  m->lastpos = g->lastpos;
   m->offp = string;
   m->beginp = start;
   m->endp = stop;
@@ -223,8 +243,6 @@ matcher(struct re_guts *g, const char *string, size_t nmatch,
       endp = fast(m, start, stop, gf, gl);
       if (endp == NULL)
         { /* a miss */
-          free(m->pmatch);
-          free(m->lastpos);
           STATETEARDOWN(m);
           return REG_NOMATCH;
         }
@@ -255,9 +273,10 @@ matcher(struct re_guts *g, const char *string, size_t nmatch,
         }
 
       /* oh my, he wants the subexpressions... */
+      /* the subexpression arrays are kept in g for the next call */
       if (m->pmatch == NULL)
         {
-          m->pmatch = openbsd_reallocarray(
+          m->pmatch = g->pmatch = openbsd_reallocarray(
             NULL, m->g->nsub + 1, sizeof ( regmatch_t ) );
         }
 
@@ -281,13 +300,12 @@ matcher(struct re_guts *g, const char *string, size_t nmatch,
         {
           if (g->nplus > 0 && m->lastpos == NULL)
             {
-              m->lastpos = openbsd_reallocarray(
+              m->lastpos = g->lastpos = openbsd_reallocarray(
                 NULL, g->nplus + 1, sizeof ( char * ) );
             }
 
           if (g->nplus > 0 && m->lastpos == NULL)
             {
-              free(m->pmatch);
               STATETEARDOWN(m);
               return REG_ESPACE;
             }
@@ -371,8 +389,6 @@ matcher(struct re_guts *g, const char *string, size_t nmatch,
         }
     }
 
-  free(m->pmatch);
-  free(m->lastpos);
   STATETEARDOWN(m);
   return 0;
 }
@@ -927,6 +943,14 @@ fast(struct match *m, const char *start, const char *stop, sopno startst,
   int i;
   const char *coldp; /* last p after which no match was underway */
 
+#ifdef SNAMES
+  if (!( m->g->iflags & NODFA ) && startst == m->g->firststate + 1
+      && stopst == m->g->laststate)
+    {
+      return dfast(m, start, stop, startst, stopst);
+    }
+
+#endif /* ifdef SNAMES */
   if (start == m->offp || ( start == m->beginp && !( m->eflags & REG_NOTBOL )))
     {
       c = OUT;
@@ -1026,6 +1050,341 @@ fast(struct match *m, const char *start, const char *stop, sopno startst,
     }
 }
 
+#ifdef SNAMES
+/*
+ * - dfa_init - build an empty DFA, or NULL if the RE can't have one
+ *
+ * Word boundaries are found by looking at the characters on either side,
+ * which a DFA on single characters can't do, so \< and \> need the NFA.
+ */
+static struct re_dfa *
+dfa_init(struct re_guts *g)
+{
+  struct re_dfa *d;
+  long sigs[NC];
+  long sig;
+  sopno pc;
+  sop s;
+  int c;
+  int k;
+
+  for (pc = 0; pc < g->nstates; pc++)
+    {
+      if (OP(g->strip[pc]) == OBOW || OP(g->strip[pc]) == OEOW)
+        {
+          return NULL;
+        }
+    }
+
+  if (( d = calloc(1, sizeof ( struct re_dfa ))) == NULL)
+    {
+      return NULL;
+    }
+
+  /* characters that match the same operators are in the same class */
+  for (c = 0; c < NC; c++)
+    {
+      sig = 0;
+      for (pc = 0; pc < g->nstates; pc++)
+        {
+          s = g->strip[pc];
+          if (( OP(s) == OCHAR && (char)c == (char)OPND(s))
+              || ( OP(s) == OANYOF && CHIN(&g->sets[OPND(s)], (char)c)))
+            {
+              SET1(sig, pc);
+            }
+        }
+
+      for (k = 0; k < d->nclass && sigs[k] != sig; k++)
+        {
+          continue;
+        }
+
+      if (k == d->nclass)
+        {
+          sigs[d->nclass++] = sig;
+        }
+
+      d->class[c] = k;
+    }
+
+  d->trans = openbsd_reallocarray(NULL, 2 * DFASETS * d->nclass,
+                                  sizeof ( short ));
+  if (d->trans == NULL)
+    {
+      free(d);
+      return NULL;
+    }
+
+  memset(d->trans, 0xff, 2 * DFASETS * d->nclass * sizeof ( short ));
+  g->dfa = d;
+  return d;
+}
+
+/*
+ * - dfa_set - find or add a DFA state for a state set, or -1 if it's full
+ */
+static int
+dfa_set(struct re_dfa *d, long st)
+{
+  unsigned long h;
+  int i;
+
+  h = (unsigned long)st;
+  h = ( h ^ ( h >> 16 )) * 0x45d9f3bUL;
+  h ^= h >> 16;
+  for (i = h & ( DFASETS * 2 - 1 ); d->hash[i] != 0;
+       i = ( i + 1 ) & ( DFASETS * 2 - 1 ))
+    {
+      if (d->sets[d->hash[i] - 1] == st)
+        {
+          return d->hash[i] - 1;
+        }
+    }
+
+  if (d->nsets == DFASETS)
+    {
+      return -1;
+    }
+
+  d->sets[d->nsets] = st;
+  d->hash[i] = ++d->nsets;
+  return d->nsets - 1;
+}
+
+/*
+ * - dfast - fast(), taking transitions from the DFA where it can
+ */
+static const char * /* where tentative match ended, or NULL */
+dfast(struct match *m, const char *start, const char *stop, sopno startst,
+      sopno stopst)
+{
+  struct re_guts *g = m->g;
+  struct re_dfa *d = g->dfa;
+  states st;
+  states fresh;
+  const char *p = start;
+  int c;
+  int lastc; /* previous c */
+  int flagch;
+  int i;
+  int cur;   /* DFA state of st, or -1 */
+  int next;  /* DFA state after c, or -1 */
+  short *tp; /* transition on c */
+  const char *coldp; /* last p after which no match was underway */
+
+  if (d == NULL && ( d = dfa_init(g)) == NULL)
+    {
+      g->iflags |= NODFA;
+      return fast(m, start, stop, startst, stopst);
+    }
+
+  if (start == m->offp || ( start == m->beginp && !( m->eflags & REG_NOTBOL )))
+    {
+      c = OUT;
+    }
+  else
+    {
+      c = *( start - 1 );
+    }
+
+  CLEAR(st);
+  SET1(st, startst);
+  st = step(g, startst, stopst, st, NOTHING, st);
+  ASSIGN(fresh, st);
+  cur = dfa_set(d, st);
+  coldp = NULL;
+  for (;;)
+    {
+      /* next character */
+      lastc = c;
+      c = ( p == m->endp ) ? OUT : *p;
+      if (EQ(st, fresh))
+        {
+          coldp = p;
+        }
+
+      /* is there an EOL and/or BOL between lastc and c? */
+      flagch = '\0';
+      i = 0;
+      if (( lastc == '\n' && g->cflags & REG_NEWLINE )
+          || ( lastc == OUT && !( m->eflags & REG_NOTBOL )))
+        {
+          flagch = BOL;
+          i = g->nbol;
+        }
+
+      if (( c == '\n' && g->cflags & REG_NEWLINE )
+          || ( c == OUT && !( m->eflags & REG_NOTEOL )))
+        {
+          flagch = ( flagch == BOL ) ? BOLEOL : EOL;
+          i += g->neol;
+        }
+
+      if (i != 0)
+        {
+          for (; i > 0; i--)
+            {
+              st = step(g, startst, stopst, st, flagch, st);
+            }
+
+          cur = dfa_set(d, st);
+        }
+
+      /* are we done? */
+      if (ISSET(st, stopst) || p == stop)
+        {
+          break; /* NOTE BREAK OUT */
+        }
+
+      /* no, we must deal with this character */
+      assert(c != OUT);
+      tp = ( cur < 0 ) ? NULL : &d->trans[cur * d->nclass + d->class[(uch)c]];
+      if (tp != NULL && *tp >= 0)
+        {
+          next = *tp;
+          st = d->sets[next];
+        }
+      else
+        {
+          st = step(g, startst, stopst, st, c, fresh);
+          next = dfa_set(d, st);
+          if (tp != NULL)
+            {
+              *tp = next;
+            }
+        }
+
+      cur = next;
+      p++;
+    }
+
+  assert(coldp != NULL);
+  m->coldp = coldp;
+  if (ISSET(st, stopst))
+    {
+      return p + 1;
+    }
+  else
+    {
+      return NULL;
+    }
+}
+
+/*
+ * - dslow - slow(), taking transitions from the DFA where it can
+ */
+static const char * /* where it ended */
+dslow(struct match *m, const char *start, const char *stop, sopno startst,
+      sopno stopst)
+{
+  struct re_guts *g = m->g;
+  struct re_dfa *d = g->dfa;
+  states st;
+  states empty;
+  const char *p = start;
+  int c;
+  int lastc; /* previous c */
+  int flagch;
+  int i;
+  int cur;   /* DFA state of st, or -1 */
+  int next;  /* DFA state after c, or -1 */
+  short *tp; /* transition on c */
+  const char *matchp; /* last p at which a match ended */
+
+  if (d == NULL && ( d = dfa_init(g)) == NULL)
+    {
+      g->iflags |= NODFA;
+      return slow(m, start, stop, startst, stopst);
+    }
+
+  if (start == m->offp || ( start == m->beginp && !( m->eflags & REG_NOTBOL )))
+    {
+      c = OUT;
+    }
+  else
+    {
+      c = *( start - 1 );
+    }
+
+  CLEAR(st);
+  SET1(st, startst);
+  st = step(g, startst, stopst, st, NOTHING, st);
+  CLEAR(empty);
+  cur = dfa_set(d, st);
+  matchp = NULL;
+  for (;;)
+    {
+      /* next character */
+      lastc = c;
+      c = ( p == m->endp ) ? OUT : *p;
+
+      /* is there an EOL and/or BOL between lastc and c? */
+      flagch = '\0';
+      i = 0;
+      if (( lastc == '\n' && g->cflags & REG_NEWLINE )
+          || ( lastc == OUT && !( m->eflags & REG_NOTBOL )))
+        {
+          flagch = BOL;
+          i = g->nbol;
+        }
+
+      if (( c == '\n' && g->cflags & REG_NEWLINE )
+          || ( c == OUT && !( m->eflags & REG_NOTEOL )))
+        {
+          flagch = ( flagch == BOL ) ? BOLEOL : EOL;
+          i += g->neol;
+        }
+
+      if (i != 0)
+        {
+          for (; i > 0; i--)
+            {
+              st = step(g, startst, stopst, st, flagch, st);
+            }
+
+          cur = dfa_set(d, st);
+        }
+
+      /* are we done? */
+      if (ISSET(st, stopst))
+        {
+          matchp = p;
+        }
+
+      if (EQ(st, empty) || p == stop)
+        {
+          break; /* NOTE BREAK OUT */
+        }
+
+      /* no, we must deal with this character */
+      assert(c != OUT);
+      tp = ( cur < 0 ) ? NULL
+                       : &d->trans[( DFASETS + cur ) * d->nclass
+                                   + d->class[(uch)c]];
+      if (tp != NULL && *tp >= 0)
+        {
+          next = *tp;
+          st = d->sets[next];
+        }
+      else
+        {
+          st = step(g, startst, stopst, st, c, empty);
+          next = dfa_set(d, st);
+          if (tp != NULL)
+            {
+              *tp = next;
+            }
+        }
+
+      cur = next;
+      p++;
+    }
+
+  return matchp;
+}
+#endif /* ifdef SNAMES */
+
 /*
  * - slow - step through the string more deliberately
  */
@@ -1043,6 +1402,14 @@ slow(struct match *m, const char *start, const char *stop, sopno startst,
   int i;
   const char *matchp; /* last p at which a match ended */
 
+#ifdef SNAMES
+  if (!( m->g->iflags & NODFA ) && startst == m->g->firststate + 1
+      && stopst == m->g->laststate)
+    {
+      return dslow(m, start, stop, startst, stopst);
+    }
+
+#endif /* ifdef SNAMES */
   if (start == m->offp || ( start == m->beginp && !( m->eflags & REG_NOTBOL )))
     {
       c = OUT;
@@ -1153,6 +1520,14 @@ step(struct re_guts *g, sopno start,  /* start state within strip */
 
   for (pc = start, INIT(here, pc); pc != stop; pc++, INC(here))
     {
+#ifdef MNAMES
+      if (( pc = mnext(bef, aft, pc, stop)) == stop)
+        {
+          break;
+        }
+
+      INIT(here, pc);
+#endif /* ifdef MNAMES */
       s = g->strip[pc];
       switch (OP(s))
         {
@@ -232,6 +232,11 @@ regcomp(regex_t *preg, const char *pattern, int cflags)
   g->mlen = 0;
   g->nsub = 0;
   g->backrefs = 0;
+  g->pmatch = NULL;
+  g->lastpos = NULL;
+  g->space = NULL;
+  g->mspace = NULL;
+  g->dfa = NULL;
 
   /* do it */
   EMIT(OEND, 0);
@@ -46,8 +46,8 @@
 /*
  * the outer shell of regexec()
  *
- * This file includes engine.c *twice*, after muchos fiddling with the
- * macros that code uses.  This lets the same code operate on two different
+ * This file includes engine.c three times, after muchos fiddling with the
+ * macros that code uses.  This lets the same code operate on three different
  * representations for state sets.
  */
 
@@ -110,6 +110,129 @@
 #undef ISSETBACK
 #undef SNAMES
 
+/*
+ * macros for manipulating states, medium version: a bit vector of up to
+ * MWORDS longs, so that patterns a little too big for one long don't fall
+ * back to a byte per state
+ */
+#define MWORDS 8
+#define MBITS ( CHAR_BIT * sizeof ( unsigned long ))
+#define MWORD(n) (( n ) / MBITS )
+#define MBIT(n) ((unsigned long)1 << (( n ) % MBITS ))
+#define states unsigned long *
+#define CLEAR(v) memset(v, 0, m->nw * sizeof ( unsigned long ))
+#define SET0(v, n) (( v )[MWORD(n)] &= ~MBIT(n))
+#define SET1(v, n) (( v )[MWORD(n)] |= MBIT(n))
+#define ISSET(v, n) ((( v )[MWORD(n)] & MBIT(n)) != 0 )
+#define ASSIGN(d, s) memcpy(d, s, m->nw * sizeof ( unsigned long ))
+#define EQ(a, b) ( memcmp(a, b, m->nw * sizeof ( unsigned long )) == 0 )
+
+#define STATEVARS                                                             \
+  long vn;                                                                    \
+  size_t nw;                                                                  \
+  unsigned long *space
+
+/* the state sets are kept in g for the next call; nv is always the same */
+#define STATESETUP(m, nv)                                                     \
+  {                                                                           \
+    ( m )->nw = MWORD(( m )->g->nstates) + 1;                                 \
+    if (( m )->g->mspace == NULL)                                             \
+    ( m )->g->mspace = openbsd_reallocarray(                                  \
+      NULL, ( m )->nw * ( nv ), sizeof ( unsigned long ));                    \
+    if (( m )->g->mspace == NULL)                                             \
+    return REG_ESPACE;                                                        \
+    ( m )->space = ( m )->g->mspace;                                          \
+    ( m )->vn = 0;                                                            \
+  }
+
+#define STATETEARDOWN(m) /* nothing */
+
+#define SETUP(v) (( v ) = &m->space[m->vn++ *m->nw] )
+#define onestate long
+#define INIT(o, n) (( o ) = ( n ))
+#define INC(o) (( o )++ )
+#define ISSTATEIN(v, o) ISSET(v, o)
+/* some abbreviations; note that some of these know variable names! */
+/* do "if I'm here, I can also be there" etc without branches */
+#define FWD(dst, src, n)                                                      \
+  (( dst )[MWORD(here + ( n ))] |=                                            \
+     (( ( src )[MWORD(here)] >> ( here % MBITS )) & 1 ) << (( here + ( n )) % MBITS ))
+#define BACK(dst, src, n)                                                     \
+  (( dst )[MWORD(here - ( n ))] |=                                            \
+     (( ( src )[MWORD(here)] >> ( here % MBITS )) & 1 ) << (( here - ( n )) % MBITS ))
+#define ISSETBACK(v, n) ISSET(v, here - ( n ))
+/* function names */
+#define MNAMES /* flag */
+
+/*
+ * - mnext - the first state from pc on that is in bef or aft, or stop
+ *
+ * step() does nothing for a state in neither set, so the medium version
+ * skips over them a word at a time.
+ */
+static sopno
+mnext(const unsigned long *bef, const unsigned long *aft, sopno pc, sopno stop)
+{
+  unsigned long w;
+  size_t i;
+
+  i = MWORD(pc);
+  w = ( bef[i] | aft[i] ) >> ( pc % MBITS );
+  if (w == 0)
+    {
+      for (pc = ( i + 1 ) * MBITS; pc < stop; pc += MBITS)
+        {
+          i++;
+          if (( w = bef[i] | aft[i] ) != 0)
+            {
+              break;
+            }
+        }
+
+      if (pc >= stop)
+        {
+          return stop;
+        }
+    }
+
+  while (( w & 0xff ) == 0)
+    {
+      w >>= 8;
+      pc += 8;
+    }
+
+  while (( w & 1 ) == 0)
+    {
+      w >>= 1;
+      pc++;
+    }
+
+  return ( pc < stop ) ? pc : stop;
+}
+
+#include "engine.c"
+
+/* now undo things */
+#undef states
+#undef CLEAR
+#undef SET0
+#undef SET1
+#undef ISSET
+#undef ASSIGN
+#undef EQ
+#undef STATEVARS
+#undef STATESETUP
+#undef STATETEARDOWN
+#undef SETUP
+#undef onestate
+#undef INIT
+#undef INC
+#undef ISSTATEIN
+#undef FWD
+#undef BACK
+#undef ISSETBACK
+#undef MNAMES
+
 /* macros for manipulating states, large version */
 #define states char *
 #define CLEAR(v) memset(v, 0, m->g->nstates)
@@ -123,19 +246,19 @@
   long vn;                                                                    \
   char *space
 
+/* the state sets are kept in g for the next call; nv is always the same */
 #define STATESETUP(m, nv)                                                     \
   {                                                                           \
-    ( m )->space = openbsd_reallocarray(                                      \
+    if (( m )->g->space == NULL)                                              \
+    ( m )->g->space = openbsd_reallocarray(                                   \
       NULL, ( m )->g->nstates, ( nv ) );                                      \
-    if (( m )->space == NULL)                                                 \
+    if (( m )->g->space == NULL)                                              \
     return REG_ESPACE;                                                        \
+    ( m )->space = ( m )->g->space;                                           \
     ( m )->vn = 0;                                                            \
   }
 
-#define STATETEARDOWN(m)                                                      \
-  {                                                                           \
-    free(( m )->space);                                                       \
-  }
+#define STATETEARDOWN(m) /* nothing */
 
 #define SETUP(v) (( v ) = &m->space[m->vn++ *m->g->nstates] )
 #define onestate long
@@ -188,6 +311,10 @@ regexec(const regex_t *preg, const char *string, size_t nmatch,
     {
       return smatcher(g, string, nmatch, pmatch, eflags);
     }
+  else if (g->nstates <= MWORDS * MBITS && !( eflags & REG_LARGE ))
+    {
+      return mmatcher(g, string, nmatch, pmatch, eflags);
+    }
   else
     {
       return lmatcher(g, string, nmatch, pmatch, eflags);
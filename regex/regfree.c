@@ -73,5 +73,12 @@ regfree(regex_t *preg)
         free(g->sets);
         free(g->setbits);
         free(g->must);
+        free(g->pmatch);
+        free(g->lastpos);
+        free(g->space);
+        free(g->mspace);
+        if (g->dfa != NULL)
+                free(g->dfa->trans);
+        free(g->dfa);
         free(g);
 }
@@ -20,6 +20,8 @@
 #include <ctype.h>
 #include <limits.h>
 #include <stdio.h>
+#include <bsd_stdlib.h>
+#include <bsd_string.h>
 
 #include "../common/common.h"
 #include "vi.h"
@@ -35,9 +37,10 @@ v_at(SCR *sp, VICMD *vp)
 {
         CB *cbp;
         CHAR_T name;
-        TEXT *tp;
-        size_t len;
-        char nbuf[20];
+        TEXT *tp, *ntp;
+        size_t blen, len;
+        int rval;
+        char *bp, *p, nbuf[20];
 
         /*
          * !!!
@@ -83,12 +86,26 @@ v_at(SCR *sp, VICMD *vp)
          * undone by a single 'u' command, i.e. the changes were grouped
          * together.  We don't get this right; I'm waiting for the new DB
          * logging code to be available.
+         *
+         * The buffer is pushed all at once, so a large buffer doesn't shift
+         * the queue once per line.
          */
-        TAILQ_FOREACH_REVERSE(tp, &cbp->textq, _texth, q)
-                if (((F_ISSET(cbp, CB_LMODE) || TAILQ_NEXT(tp, q)) &&
-                    v_event_push(sp, NULL, "\n", 1, 0)) ||
-                    v_event_push(sp, NULL, tp->lb, tp->len, 0))
-                        return (1);
+        len = 0;
+        TAILQ_FOREACH(tp, &cbp->textq, q)
+                len += tp->len + 1;
+        GET_SPACE_RET(sp, bp, blen, len);
+        for (p = bp, tp = TAILQ_FIRST(&cbp->textq); tp != NULL; tp = ntp) {
+                ntp = TAILQ_NEXT(tp, q);
+                if (tp->len != 0)
+                        memcpy(p, tp->lb, tp->len);
+                p += tp->len;
+                if (F_ISSET(cbp, CB_LMODE) || ntp != NULL)
+                        *p++ = '\n';
+        }
+        rval = v_event_push(sp, NULL, bp, p - bp, 0);
+        FREE_SPACE(sp, bp, blen);
+        if (rval)
+                return (1);
 
         /*
          * !!!
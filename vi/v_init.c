@@ -41,8 +41,9 @@ v_screen_copy(SCR *orig, SCR *sp)
         CALLOC_RET(orig, nvip, 1, sizeof(VI_PRIVATE));
         sp->vi_private = nvip;
 
-        /* Invalidate the line size cache. */
+        /* Invalidate the line size and column caches. */
         VI_SCR_CFLUSH(nvip);
+        VI_COL_CFLUSH(nvip);
 
         if (orig == NULL) {
                 nvip->csearchdir = CNOTSET;
@@ -82,6 +83,8 @@ v_screen_end(SCR *sp)
 
         if ((vip = VIP(sp)) == NULL)
                 return (0);
+        free(vip->ck);
+        free(vip->rs);
         free(vip->keyw);
         free(vip->rep);
         free(vip->ps);
@@ -101,6 +104,10 @@ v_screen_end(SCR *sp)
 int
 v_optchange(SCR *sp, int offset, char *str, unsigned long *valp)
 {
+        /* Any option may change how lines are painted. */
+        if (VIP(sp) != NULL)
+                VI_ROW_CFLUSH(VIP(sp));
+
         switch (offset) {
         case O_PARAGRAPHS:
                 return (v_buildps(sp, str, O_STR(sp, O_SECTIONS)));
@@ -30,6 +30,9 @@
 
 #define MINIMUM(a, b)   (((a) < (b)) ? (a) : (b))
 
+#define GAPMIN          1024            /* Smallest tail worth a gap. */
+#define GAPMAX          (1024 * 1024)   /* Largest gap. */
+
 static int       txt_abbrev(SCR *, TEXT *, CHAR_T *, int, int *, int *);
 static void      txt_ai_resolve(SCR *, TEXT *, int *);
 static TEXT     *txt_backup(SCR *, TEXTH *, TEXT *, u_int32_t *);
@@ -45,6 +48,8 @@ static int       txt_map_end(SCR *);
 static int       txt_map_init(SCR *);
 static int       txt_margin(SCR *, TEXT *, TEXT *, int *, u_int32_t);
 static void      txt_nomorech(SCR *);
+static int       txt_paste(SCR *, TEXT **, CHAR_T *, size_t, u_int32_t *,
+                    size_t *);
 static void      txt_Rresolve(SCR *, TEXTH *, TEXT *, const size_t);
 static int       txt_resolve(SCR *, TEXTH *, u_int32_t);
 static int       txt_showmatch(SCR *, TEXT *);
@@ -186,6 +191,7 @@ txt_map_end(SCR *sp)
                         for (cnt = sp->t_rows; cnt <= sp->t_maxrows; ++cnt) {
                                 (void)sp->gp->scr_move(sp, cnt, 0);
                                 (void)sp->gp->scr_clrtoeol(sp);
+                                VI_ROW_CLR(vip, cnt);
                         }
                         TMAP = HMAP + (sp->t_rows - 1);
                 } else
@@ -222,6 +228,14 @@ txt_map_end(SCR *sp)
 #define UNMAP_TST                                                       \
         FL_ISSET(ec_flags, EC_MAPINPUT) && LF_ISSET(TXT_INFOLINE)
 
+/*
+ * Ordinary characters, and the <escape> starting the next repetition of a
+ * counted insert, are handled without closing the gap after the cursor.
+ */
+#define GAP_KEEP(evp)                                                   \
+        ((evp)->e_value == K_NOTUSED || ((evp)->e_value == K_ESCAPE &&  \
+        rcount > 1 && !LF_ISSET(TXT_ADDNEWLINE | TXT_REPLACE)))
+
 /*
  * Internally, we maintain tp->lno and tp->cno, externally, everyone uses
  * sp->lno and sp->cno.  Make them consistent as necessary.
@@ -278,6 +292,7 @@ v_txt(SCR *sp, VICMD *vp, MARK *tm, const char *lp, size_t len,
          * and everyone knows that the text buffer is in use.
          */
         F_SET(sp, SC_TINPUT);
+        sp->tilast = NULL;
 
         /*
          * Get one TEXT structure with some initial buffer space, reusing
@@ -292,7 +307,7 @@ v_txt(SCR *sp, VICMD *vp, MARK *tm, const char *lp, size_t len,
                         text_lfree(tiqh);
                         goto newtp;
                 }
-                tp->ai = tp->insert = tp->offset = tp->owrite = 0;
+                tp->ai = tp->gap = tp->insert = tp->offset = tp->owrite = 0;
                 if (lp != NULL) {
                         tp->len = len;
                         memmove(tp->lb, lp, len);
@@ -456,7 +471,7 @@ newtp:          if ((tp = text_init(sp, lp, len, len + 32)) == NULL)
         filec_redraw = hexcnt = showmatch = 0;
 
         /* Initialize input flags. */
-        ec_flags = LF_ISSET(TXT_MAPINPUT) ? EC_MAPINPUT : 0;
+        ec_flags = (LF_ISSET(TXT_MAPINPUT) ? EC_MAPINPUT : 0) | EC_PASTE;
 
         /* Refresh the screen. */
         UPDATE_POSITION(sp, tp);
@@ -469,8 +484,18 @@ newtp:          if ((tp = text_init(sp, lp, len, len + 32)) == NULL)
 
         /* Get an event. */
         evp = &ev;
-next:   if (v_event_get(sp, evp, 0, ec_flags))
+next:   if (v_event_get(sp, evp, 0, ec_flags)) {
+                text_gapclose(tp);
                 return (1);
+        }
+
+        /*
+         * Ordinary characters go into the gap left after the cursor by the
+         * last one inserted, see txt_insch(); most anything else needs the
+         * line contiguous again.
+         */
+        if (evp->e_event != E_CHARACTER || !GAP_KEEP(evp))
+                text_gapclose(tp);
 
         /*
          * If file completion overwrote part of the screen and nothing else has
@@ -505,6 +530,26 @@ next:   if (v_event_get(sp, evp, 0, ec_flags))
         case E_EOF:
                 F_SET(sp, SC_EXIT_FORCE);
                 return (1);
+        case E_PASTE:
+                /*
+                 * Pasted text goes in as is, without maps, abbreviations,
+                 * autoindent or wrapmargin, unless the keys are needed one
+                 * at a time, e.g., for a script window or the colon command
+                 * line.  Then push them back as ordinary input.
+                 */
+                if (quote != Q_NOTSET || hexcnt != 0 ||
+                    LF_ISSET(TXT_CR | TXT_INFOLINE | TXT_REPLACE) ||
+                    FL_ISSET(is_flags, IS_RUNNING)) {
+                        if (v_event_push(sp, NULL, evp->e_csp, evp->e_len, 0))
+                                goto err;
+                        goto next;
+                }
+                if (txt_paste(sp, &tp, evp->e_csp, evp->e_len,
+                    &flags, LF_ISSET(TXT_RECORD) ? &rcol : NULL))
+                        goto err;
+                if (abb != AB_NOTSET)
+                        abb = AB_NOTWORD;
+                goto resolve;
         case E_REPAINT:
                 if (vs_repaint(sp, &ev))
                         return (1);
@@ -582,6 +627,8 @@ next:   if (v_event_get(sp, evp, 0, ec_flags))
                 if (LF_ISSET(TXT_FILEC) && O_STR(sp, O_FILEC) != NULL &&
                     O_STR(sp, O_FILEC)[0] == evp->e_c)
                         L__filec = 1;
+                if (L__cedit == 1 || L__filec == 1)
+                        text_gapclose(tp);
                 if (L__cedit == 1 && (L__filec == 0 || tp->cno == tp->offset)) {
                         tp->term = TERM_CEDIT;
                         goto k_escape;
@@ -615,8 +662,11 @@ next:   if (v_event_get(sp, evp, 0, ec_flags))
                 vip->rep[rcol++] = *evp;
         }
 
-replay: if (LF_ISSET(TXT_REPLAY))
+replay: if (LF_ISSET(TXT_REPLAY)) {
                 evp = vip->rep + rcol++;
+                if (!GAP_KEEP(evp))
+                        text_gapclose(tp);
+        }
 
         /* Wrapmargin check for leading space. */
         if (wm_skip) {
@@ -660,6 +710,7 @@ replay: if (LF_ISSET(TXT_REPLAY))
          */
         if (hexcnt > 1 && !isxdigit(evp->e_c)) {
                 hexcnt = 0;
+                text_gapclose(tp);
                 if (txt_hex(sp, tp))
                         goto err;
         }
@@ -1289,6 +1340,8 @@ insq_ch:        /*
 
 insl_ch:        if (txt_insch(sp, tp, &evp->e_c, flags))
                         goto err;
+                if (quote != Q_NOTSET || hexcnt != 0)
+                        text_gapclose(tp);
 
                 /*
                  * If we're using K_VLNEXT to quote the next character, then
@@ -1430,6 +1483,7 @@ resolve:/*
         goto next;
 
 done:   /* Leave input mode. */
+        text_gapclose(tp);
         F_CLR(sp, SC_TINPUT);
 
         /* If recording for playback, save it. */
@@ -1448,6 +1502,7 @@ done:   /* Leave input mode. */
 
 err:
 alloc_err:
+        text_gapclose(tp);
         F_CLR(sp, SC_TINPUT);
         txt_err(sp, &sp->tiq);
         return (1);
@@ -1582,6 +1637,7 @@ search: if (isinfoline) {
          * queue would have to be adjusted, and the line state when an initial
          * abbreviated character was received would have to be saved.
          */
+        text_gapclose(tp);
         ch = *pushcp;
         if (v_event_push(sp, NULL, &ch, 1, CH_ABBREVIATED))
                 return (1);
@@ -1834,6 +1890,7 @@ txt_backup(SCR *sp, TEXTH *tiqh, TEXT *tp, u_int32_t *flagsp)
         /* Release the current TEXT. */
         TAILQ_REMOVE(tiqh, tp, q);
         text_free(tp);
+        sp->tilast = NULL;
 
         /* Update the old line on the screen. */
         if (vs_change(sp, ntp->lno + 1, LINE_DELETE))
@@ -2318,6 +2375,7 @@ txt_err(SCR *sp, TEXTH *tiqh)
 
         /* Redraw the screen, just in case. */
         F_SET(sp, SC_SCR_REDRAW);
+        VI_ROW_CFLUSH(VIP(sp));
 }
 
 /*
@@ -2411,7 +2469,7 @@ static int
 txt_insch(SCR *sp, TEXT *tp, CHAR_T *chp, unsigned int flags)
 {
         CHAR_T *kp, savech;
-        size_t chlen, cno, copydown, olen, nlen;
+        size_t chlen, cno, copydown, gap, olen, nlen;
         char *p;
 
         /*
@@ -2500,6 +2558,32 @@ txt_insch(SCR *sp, TEXT *tp, CHAR_T *chp, unsigned int flags)
                 }
         }
 
+        /* If there's a gap after the cursor, fill it. */
+        if (tp->gap != 0) {
+                --tp->gap;
+                ++tp->len;
+                tp->lb[tp->cno++] = *chp;
+                return (0);
+        }
+
+        /*
+         * If there's a lot of text after the cursor, move it up once and
+         * leave a gap for the characters to be inserted into, instead of
+         * moving it up for each character.  The gap stays open until input
+         * other than ordinary characters arrives, or until something needs
+         * the line contiguous; the screen code steps over it, see db_gget().
+         */
+        if (tp->insert >= GAPMIN) {
+                gap = MINIMUM(tp->insert, GAPMAX);
+                BINC_RET(sp, tp->lb, tp->lb_len, tp->len + gap + 1);
+                memmove(tp->lb + tp->cno + gap + 1,
+                    tp->lb + tp->cno, tp->insert);
+                tp->gap = gap;
+                ++tp->len;
+                tp->lb[tp->cno++] = *chp;
+                return (0);
+        }
+
         /* Check to see if the character fits into the input buffer. */
         BINC_RET(sp, tp->lb, tp->lb_len, tp->len + 1);
 
@@ -2797,6 +2881,7 @@ txt_margin(SCR *sp, TEXT *tp, TEXT *wmtp, int *didbreak, u_int32_t flags)
          * line -- it's going to be used to set the cursor value when we
          * move to the new line.
          */
+        text_gapclose(tp);
         wmtp->lb = p + 1;
         wmtp->offset = len;
         wmtp->insert = LF_ISSET(TXT_APPENDEOL) ?  tp->insert - 1 : tp->insert;
@@ -2891,3 +2976,109 @@ txt_nomorech(SCR *sp)
 {
         msgq(sp, M_BERR, "No more characters to erase");
 }
+
+/*
+ * txt_paste --
+ *      Insert pasted text, breaking lines at <carriage-return>, <newline>
+ *      and <carriage-return><newline> the way entering a <carriage-return>
+ *      would, but without any of the per-character input processing.  If
+ *      recording for replay, record the text as quoted characters.
+ */
+static int
+txt_paste(SCR *sp, TEXT **tpp, CHAR_T *p, size_t len, u_int32_t *flagsp,
+    size_t *rcolp)
+{
+        EVENT *evp;
+        TEXT *ntp, *tp;
+        VI_PRIVATE *vip;
+        CHAR_T *ep, *sv_p;
+        size_t n;
+
+        tp = *tpp;
+        vip = VIP(sp);
+
+        /*
+         * Characters the user committed to changing, e.g., by a 'c' command,
+         * are discarded when input ends anyway, so get them out of the way.
+         */
+        if (tp->owrite != 0) {
+                memmove(tp->lb + tp->cno,
+                    tp->lb + tp->cno + tp->owrite, tp->insert);
+                tp->len -= tp->owrite;
+                tp->owrite = 0;
+        }
+
+        for (sv_p = p, ep = p + len; p < ep;) {
+                /* Insert the characters up to the next line break. */
+                for (n = 0; p + n < ep && p[n] != '\r' && p[n] != '\n'; ++n)
+                        ;
+                if (n != 0) {
+                        BINC_RET(sp, tp->lb, tp->lb_len, tp->len + n);
+                        memmove(tp->lb + tp->cno + n,
+                            tp->lb + tp->cno, tp->insert);
+                        memcpy(tp->lb + tp->cno, p, n);
+                        tp->cno += n;
+                        tp->len += n;
+                        p += n;
+                }
+                if (p == ep)
+                        break;
+                if (*p++ == '\r' && p < ep && *p == '\n')
+                        ++p;
+
+                /* Delete any appended cursor, see v_txt():LINE_RESOLVE. */
+                if (FL_ISSET(*flagsp, TXT_APPENDEOL) && tp->insert > 0) {
+                        --tp->len;
+                        --tp->insert;
+                }
+
+                /* Break the line, see v_txt():k_cr. */
+                tp->sv_len = tp->len;
+                tp->sv_cno = tp->cno;
+                tp->len = tp->cno;
+                tp->R_erase = 0;
+                if ((ntp = text_init(sp, tp->lb + tp->cno,
+                    tp->insert, tp->insert + 32)) == NULL)
+                        return (1);
+                TAILQ_INSERT_TAIL(&sp->tiq, ntp, q);
+                ntp->insert = tp->insert;
+                ntp->lno = tp->lno + 1;
+                ntp->cno = 0;
+                if (ntp->insert == 0) {
+                        BINC_RET(sp, ntp->lb, ntp->lb_len, ntp->len + 1);
+                        FL_SET(*flagsp, TXT_APPENDEOL);
+                        ntp->lb[ntp->cno] = CH_CURSOR;
+                        ++ntp->insert;
+                        ++ntp->len;
+                }
+                tp = ntp;
+        }
+        *tpp = tp;
+
+        /*
+         * The lines below the cursor moved without the screen being told, so
+         * reformat it, and forget what the rows showed.
+         */
+        F_SET(sp, SC_SCR_REFORMAT);
+        VI_ROW_CFLUSH(vip);
+
+        if (rcolp == NULL)
+                return (0);
+        BINC_RET(sp, vip->rep, vip->rep_len, (*rcolp + len) * sizeof(EVENT));
+        for (p = sv_p; p < ep; ++p) {
+                evp = vip->rep + (*rcolp)++;
+                evp->e_event = E_CHARACTER;
+                if (*p == '\r' || *p == '\n') {
+                        if (*p == '\r' && p + 1 < ep && p[1] == '\n')
+                                ++p;
+                        evp->e_c = '\r';
+                        evp->e_value = K_CR;
+                        evp->e_flags = 0;
+                } else {
+                        evp->e_c = *p;
+                        evp->e_value = KEY_VAL(sp, *p);
+                        evp->e_flags = CH_QUOTED;
+                }
+        }
+        return (0);
+}
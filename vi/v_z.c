@@ -143,5 +143,6 @@ vs_crel(SCR *sp, long count)
         if (HMAP != NULL)
                 TMAP = HMAP + (sp->t_rows - 1);
         F_SET(sp, SC_SCR_REDRAW);
+        VI_ROW_CFLUSH(VIP(sp));
         return (0);
 }
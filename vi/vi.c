@@ -21,6 +21,7 @@
 #include <errno.h>
 #include <limits.h>
 #include <stdio.h>
+#include <time.h>
 #include <bsd_stdlib.h>
 #include <bsd_string.h>
 #include <bsd_unistd.h>
@@ -85,6 +86,7 @@ vi(SCR **spp)
         /* Initialize the vi screen. */
         if (v_init(sp))
                 return (1);
+        v_phase(gp, "vi screen");
 
         /* Set the focus. */
         (void)sp->gp->scr_rename(sp, sp->frp->name, 1);
@@ -104,6 +106,14 @@ vi(SCR **spp)
                         sp->showmode = SM_COMMAND;
                         if (vs_refresh(sp, 0))
                                 goto ret;
+                        if (F_ISSET(gp, G_STARTUP)) {
+                                v_phase(gp, "paint");
+                                F_CLR(gp, G_STARTUP);
+                        }
+
+                        /* Take a snapshot put off by file_init(). */
+                        if (F_ISSET(sp->ep, F_SNAPSHOT))
+                                (void)db_snapshot(sp);
                 }
 
                 /* Set the new favorite position. */
@@ -167,6 +177,7 @@ vi(SCR **spp)
                 case GC_OK:
                         break;
                 }
+                gp->lat_cmd = vp->key;
 
                 /* Check for security setting. */
                 if (F_ISSET(vp->kp, V_SECURE) && O_ISSET(sp, O_SECURE)) {
@@ -404,6 +415,7 @@ intr:                   CLR_INTERRUPT(sp);
                         F_CLR(sp, SC_FSWITCH);
                         F_CLR(sp, SC_SCR_TOP);
                         F_SET(sp, SC_SCR_CENTER);
+                        VI_ROW_CFLUSH(vip);
                         (void)sp->gp->scr_rename(sp, sp->frp->name, 1);
                 }
 
@@ -1022,6 +1034,7 @@ v_init(SCR *sp)
 
         /* Paint the screen image from scratch. */
         F_SET(vip, VIP_N_EX_PAINT);
+        VI_ROW_CFLUSH(vip);
 
         return (0);
 }
@@ -1248,6 +1261,171 @@ v_key(SCR *sp, int command_events, EVENT *evp, u_int32_t ec_flags)
         /* NOTREACHED */
 }
 
+/*
+ * v_lat_key --
+ *      Note the arrival of keys from the terminal, unless an earlier key
+ *      is still waiting for the screen to be painted.
+ *
+ * PUBLIC: void v_lat_key(SCR *, EVENT *);
+ */
+void
+v_lat_key(SCR *sp, EVENT *evp)
+{
+        GS *gp;
+
+        gp = sp->gp;
+        if (gp->lat_nsec != 0 || !F_ISSET(sp, SC_VI))
+                return;
+        if (evp->e_event == E_CHARACTER)
+                gp->lat_key = evp->e_c;
+        else if (evp->e_event == E_STRING && evp->e_len != 0)
+                gp->lat_key = evp->e_csp[0];
+        else
+                return;
+        gp->lat_nsec = nsec_now();
+        gp->lat_gets = gp->db_hits + gp->db_misses;
+        gp->lat_chgs = gp->db_changes;
+        gp->lat_bytes = gp->scr_bytes;
+}
+
+/*
+ * v_lat_paint --
+ *      Record the time from the first key waiting to be painted to the
+ *      screen being painted, and remember the event if it was slow.
+ *
+ * PUBLIC: void v_lat_paint(SCR *);
+ */
+void
+v_lat_paint(SCR *sp)
+{
+        GS *gp;
+        unsigned long usec;
+        unsigned int b, i, shift;
+
+        gp = sp->gp;
+        usec = (nsec_now() - gp->lat_nsec) / 1000;
+        gp->lat_nsec = 0;
+
+        /*
+         * Below 8us, a bucket for each value; above, 8 buckets for each
+         * power of two, so the buckets are within 12.5% of the values.
+         */
+        if (usec < 8)
+                i = usec;
+        else {
+                for (b = 3; usec >> (b + 1) != 0; ++b);
+                shift = b - 3;
+                i = 8 * shift + (usec >> shift);
+                if (i >= LAT_BUCKETS)
+                        i = LAT_BUCKETS - 1;
+        }
+        ++gp->lat_hist[i];
+        ++gp->lat_cnt;
+        if (usec > gp->lat_max)
+                gp->lat_max = usec;
+
+        if (usec >= LAT_SLOW) {
+                i = gp->lat_next++ % LAT_RING;
+                gp->lat_ring[i].when = time(NULL) - usec / 1000000;
+                gp->lat_ring[i].usec = usec;
+                gp->lat_ring[i].key = gp->lat_key;
+                gp->lat_ring[i].cmd = gp->lat_cmd;
+                gp->lat_ring[i].gets =
+                    gp->db_hits + gp->db_misses - gp->lat_gets;
+                gp->lat_ring[i].chgs = gp->db_changes - gp->lat_chgs;
+                gp->lat_ring[i].bytes = gp->scr_bytes - gp->lat_bytes;
+        }
+
+        /*
+         * Keys already queued behind a forced paint won't be read from the
+         * terminal again, start timing the next one now.
+         */
+        if (KEYS_WAITING(sp))
+                v_lat_key(sp, &gp->i_event[gp->i_next]);
+}
+
+/*
+ * v_lat_fmt --
+ *      Format the latency percentiles.
+ *
+ * PUBLIC: void v_lat_fmt(GS *, char *, size_t);
+ */
+void
+v_lat_fmt(GS *gp, char *bp, size_t blen)
+{
+        static const double pcts[] = { 50, 90, 99, 99.9 };
+        unsigned long cnt, sum, top[4];
+        unsigned int i, j, shift;
+
+        if (gp->lat_cnt == 0) {
+                (void)snprintf(bp, blen, "key latency: 0 events\n");
+                return;
+        }
+
+        /* Report the highest value of the bucket each percentile is in. */
+        for (i = j = 0, sum = 0; i < LAT_BUCKETS && j < 4; ++i) {
+                sum += gp->lat_hist[i];
+                for (; j < 4; ++j) {
+                        cnt = gp->lat_cnt * pcts[j] / 100 + 0.5;
+                        if (sum < (cnt == 0 ? 1 : cnt))
+                                break;
+                        if (i < 16)
+                                top[j] = i;
+                        else {
+                                shift = i / 8 - 1;
+                                top[j] = ((i - 8 * shift + 1) << shift) - 1;
+                        }
+                        if (top[j] > gp->lat_max)
+                                top[j] = gp->lat_max;
+                }
+        }
+        for (; j < 4; ++j)
+                top[j] = gp->lat_max;
+        (void)snprintf(bp, blen,
+            "key latency: %lu events, 50%% %.1f ms, 90%% %.1f ms, "
+            "99%% %.1f ms, 99.9%% %.1f ms, max %.1f ms\n", gp->lat_cnt,
+            top[0] / 1e3, top[1] / 1e3, top[2] / 1e3, top[3] / 1e3,
+            gp->lat_max / 1e3);
+}
+
+/*
+ * v_lat_slow --
+ *      Format the n'th slow event remembered, oldest first.  Return 1 if
+ *      there isn't one.
+ *
+ * PUBLIC: int v_lat_slow(SCR *, unsigned int, char *, size_t);
+ */
+int
+v_lat_slow(SCR *sp, unsigned int n, char *bp, size_t blen)
+{
+        GS *gp;
+        size_t len;
+        unsigned int first, i;
+        char kbuf[MAX_CHARACTER_COLUMNS + 1], tbuf[16];
+
+        gp = sp->gp;
+        first = gp->lat_next > LAT_RING ? gp->lat_next - LAT_RING : 0;
+        if (first + n >= gp->lat_next)
+                return (1);
+        i = (first + n) % LAT_RING;
+        len = strftime(tbuf, sizeof(tbuf),
+            "%H:%M:%S", localtime(&gp->lat_ring[i].when));
+        tbuf[len] = '\0';
+
+        /* KEY_NAME may return a buffer the next call overwrites. */
+        (void)openbsd_strlcpy(kbuf,
+            (char *)KEY_NAME(sp, gp->lat_ring[i].key), sizeof(kbuf));
+        (void)snprintf(bp, blen,
+            "%s %8.1f ms key %s command %s, %lu lines changed, "
+            "%lu db_get calls, %llu bytes painted\n", tbuf,
+            gp->lat_ring[i].usec / 1e3, kbuf,
+            gp->lat_ring[i].cmd == 0 ?
+            "-" : (char *)KEY_NAME(sp, gp->lat_ring[i].cmd),
+            gp->lat_ring[i].chgs, gp->lat_ring[i].gets,
+            gp->lat_ring[i].bytes);
+        return (0);
+}
+
 #if defined(DEBUG) && defined(COMLOG)
 /*
  * v_comlog --
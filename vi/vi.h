@@ -308,6 +308,50 @@ typedef struct _vi_private {
         size_t  ss_screens;     /* vi_opt_screens cached return value. */
 #define VI_SCR_CFLUSH(vip)      ((vip)->ss_lno = OOBLNO)
 
+        /*
+         * vs_columns() checkpoints for the last long line it measured: the
+         * column state before every VS_CKSTRIDE'th byte of the line, so the
+         * line isn't walked from its start for every column query.  They're
+         * tied to the line's file and change count and the display options.
+         */
+#define VS_CKSTRIDE     4096
+        struct _vs_ckpt {
+                size_t  scno;           /* 0-N: screen columns so far. */
+                size_t  curoff;         /* 0-N: column in the screen line. */
+        } *ck;
+        size_t   ck_cnt;        /* Checkpoints filled in. */
+        size_t   ck_len;        /* Checkpoints allocated. */
+        EXF     *ck_ep;         /* Checkpointed file. */
+        recno_t  ck_lno;        /* 1-N: Checkpointed line number. */
+        unsigned long ck_gen;   /* File change count. */
+        size_t   ck_cols;       /* Screen columns. */
+        unsigned long ck_ts;    /* Tabstop. */
+        int      ck_opts;       /* List, leftright and number options. */
+#define VI_COL_CFLUSH(vip)      ((vip)->ck_lno = OOBLNO)
+
+        /*
+         * What vs_line() last painted on each text row of the screen, so a
+         * full repaint can skip the rows that still show the right thing.
+         * Rows are valid only in the current epoch; anything that writes
+         * on the text rows behind vs_line()'s back starts a new one.
+         */
+        struct _vs_row {
+                recno_t  lno;           /* 1-N: Painted line, or OOBLNO. */
+                size_t   coff;          /* 0-N: Painted column offset. */
+                size_t   soff;          /* 1-N: Painted screen offset. */
+                unsigned long epoch;    /* Epoch the row was painted in. */
+        } *rs;
+        size_t   rs_len;        /* Rows allocated. */
+        size_t   rs_cols;       /* Screen columns. */
+        EXF     *rs_ep;         /* Painted file. */
+        unsigned long rs_gen;   /* File change count. */
+        unsigned long rs_epoch; /* Current epoch. */
+#define VI_ROW_CFLUSH(vip)      (++(vip)->rs_epoch)
+#define VI_ROW_CLR(vip, row) do {                                       \
+        if ((size_t)(row) < (vip)->rs_len)                              \
+                (vip)->rs[row].lno = OOBLNO;                            \
+} while (0)
+
         size_t  srows;          /* 1-N: rows in the terminal/window. */
         recno_t olno;           /* 1-N: old cursor file line. */
         size_t  ocno;           /* 0-N: old file cursor column. */
@@ -19,11 +19,16 @@
 #include <bitstring.h>
 #include <limits.h>
 #include <stdio.h>
+#include <bsd_stdlib.h>
 #include <bsd_string.h>
 
 #include "../common/common.h"
 #include "vi.h"
 
+static int      vs_row_painted(SCR *, SMAP *);
+static void     vs_row_set(SCR *, SMAP *);
+static int      vs_row_sync(SCR *, VI_PRIVATE *);
+
 /*
  * vs_line --
  *      Update one line on the screen.
@@ -36,7 +41,7 @@ vs_line(SCR *sp, SMAP *smp, size_t *yp, size_t *xp)
         CHAR_T *kp;
         GS *gp;
         SMAP *tsmp;
-        size_t chlen = 0, cno_cnt, cols_per_screen, len, nlen;
+        size_t chlen = 0, cno_cnt, cols_per_screen, glen, goff, len, nlen;
         size_t offset_in_char, offset_in_line, oldx, oldy;
         size_t scno, skip_cols, skip_screens;
         int ch = 0, dne, is_cached, is_partial, is_tab, no_draw;
@@ -67,6 +72,13 @@ vs_line(SCR *sp, SMAP *smp, size_t *yp, size_t *xp)
         if (yp == NULL && (is_cached || no_draw))
                 return (0);
 
+        /*
+         * If the row still shows this part of the line, the only reason to
+         * look at the line is to find the cursor.
+         */
+        if ((yp == NULL || smp->lno != sp->lno) && vs_row_painted(sp, smp))
+                return (0);
+
         /*
          * A nasty side effect of this routine is that it returns the screen
          * position for the "current" character.  Not pretty, but this is the
@@ -81,8 +93,13 @@ vs_line(SCR *sp, SMAP *smp, size_t *yp, size_t *xp)
         (void)gp->scr_cursor(sp, &oldy, &oldx);
         (void)gp->scr_move(sp, smp - HMAP, 0);
 
-        /* Get the line. */
-        dne = db_get(sp, smp->lno, 0, &p, &len);
+        /*
+         * Get the line.  If it's being input and is split by a gap after
+         * the cursor, step over the gap rather than closing it.
+         */
+        dne = db_gget(sp, smp->lno, 0, &p, &len, &goff, &glen);
+#define LINECH(off)                                                     \
+        (*(unsigned char *)(p + (off) + ((off) >= goff ? glen : 0)))
 
         /*
          * Special case if we're printing the info/mode line.  Skip printing
@@ -183,6 +200,7 @@ empty:                                  (void)gp->scr_addstr(sp,
 
                 (void)gp->scr_clrtoeol(sp);
                 (void)gp->scr_move(sp, oldy, oldx);
+                vs_row_set(sp, smp);
                 return (0);
         }
 
@@ -206,7 +224,6 @@ empty:                                  (void)gp->scr_addstr(sp,
         if (skip_cols == 0) {
                 smp->c_sboff = offset_in_line = 0;
                 smp->c_scoff = offset_in_char = 0;
-                p = &p[offset_in_line];
                 goto display;
         }
 
@@ -214,7 +231,6 @@ empty:                                  (void)gp->scr_addstr(sp,
         if (is_cached) {
                 offset_in_line = smp->c_sboff;
                 offset_in_char = smp->c_scoff;
-                p = &p[offset_in_line];
 
                 /* Set cols_per_screen to 2nd and later line length. */
                 if (O_ISSET(sp, O_LEFTRIGHT) || skip_cols > cols_per_screen)
@@ -236,7 +252,6 @@ empty:                                  (void)gp->scr_addstr(sp,
                 /* Put starting info for this line in the cache. */
                 smp->c_sboff = offset_in_line;
                 smp->c_scoff = offset_in_char;
-                p = &p[offset_in_line];
 
                 /* Set cols_per_screen to 2nd and later line length. */
                 if (O_ISSET(sp, O_LEFTRIGHT) || skip_cols > cols_per_screen)
@@ -251,7 +266,7 @@ empty:                                  (void)gp->scr_addstr(sp,
         /* Do it the hard way, for leftright scrolling screens. */
         if (O_ISSET(sp, O_LEFTRIGHT)) {
                 for (; offset_in_line < len; ++offset_in_line) {
-                        chlen = (ch = *(unsigned char *)p++) == '\t' && !list_tab ?
+                        chlen = (ch = LINECH(offset_in_line)) == '\t' && !list_tab ?
                             TAB_OFF(scno) : KEY_LEN(sp, ch);
                         if ((scno += chlen) >= skip_cols)
                                 break;
@@ -265,7 +280,6 @@ empty:                                  (void)gp->scr_addstr(sp,
                         smp->c_sboff = offset_in_line;
                         smp->c_scoff =
                             offset_in_char = chlen - (scno - skip_cols);
-                        --p;
                 } else {
                         smp->c_sboff = ++offset_in_line;
                         smp->c_scoff = 0;
@@ -275,7 +289,7 @@ empty:                                  (void)gp->scr_addstr(sp,
         /* Do it the hard way, for historic line-folding screens. */
         else {
                 for (; offset_in_line < len; ++offset_in_line) {
-                        chlen = (ch = *(unsigned char *)p++) == '\t' && !list_tab ?
+                        chlen = (ch = LINECH(offset_in_line)) == '\t' && !list_tab ?
                             TAB_OFF(scno) : KEY_LEN(sp, ch);
                         if ((scno += chlen) < cols_per_screen)
                                 continue;
@@ -296,7 +310,6 @@ empty:                                  (void)gp->scr_addstr(sp,
                 if (scno != 0) {
                         smp->c_sboff = offset_in_line;
                         smp->c_scoff = offset_in_char = chlen - scno;
-                        --p;
                 } else {
                         smp->c_sboff = ++offset_in_line;
                         smp->c_scoff = 0;
@@ -326,7 +339,7 @@ display:
         /* This is the loop that actually displays characters. */
         for (is_partial = 0, scno = 0;
             offset_in_line < len; ++offset_in_line, offset_in_char = 0) {
-                if ((ch = *(unsigned char *)p++) == '\t' && !list_tab) {
+                if ((ch = LINECH(offset_in_line)) == '\t' && !list_tab) {
                         scno += chlen = TAB_OFF(scno) - offset_in_char;
                         is_tab = 1;
                 } else {
@@ -450,6 +463,8 @@ display:
         if (cbp > cbuf)
                 FLUSH(gp, sp, cbp, cbuf);
 
+        vs_row_set(sp, smp);
+
 ret1:   (void)gp->scr_move(sp, oldy, oldx);
         return (0);
 }
@@ -465,11 +480,13 @@ vs_number(SCR *sp)
 {
         GS *gp;
         SMAP *smp;
+        VI_PRIVATE *vip;
         size_t len, oldy, oldx;
         int exist;
         char nbuf[10];
 
         gp = sp->gp;
+        vip = VIP(sp);
 
         /* No reason to do anything if we're in input mode on the info line. */
         if (F_ISSET(sp, SC_TINPUT_INFO))
@@ -503,6 +520,11 @@ vs_number(SCR *sp)
                 if (smp->lno != 1 && !exist && !db_exist(sp, smp->lno))
                         break;
 
+                /* The number may not match what's painted on the row. */
+                if (vip->rs_len > (size_t)(smp - HMAP) &&
+                    vip->rs[smp - HMAP].lno != smp->lno)
+                        VI_ROW_CLR(vip, smp - HMAP);
+
                 (void)gp->scr_move(sp, smp - HMAP, 0);
                 len = snprintf(nbuf, sizeof(nbuf), O_NUMBER_FMT, (unsigned long)smp->lno);
                 if (len >= sizeof(nbuf))
@@ -512,3 +534,167 @@ vs_number(SCR *sp)
         (void)gp->scr_move(sp, oldy, oldx);
         return (0);
 }
+
+/*
+ * vs_row_change --
+ *      Update the painted rows for a change to a line of the file.
+ *
+ * PUBLIC: void vs_row_change(SCR *, recno_t, lnop_t);
+ */
+void
+vs_row_change(SCR *sp, recno_t lno, lnop_t op)
+{
+        VI_PRIVATE *vip;
+        struct _vs_row *rp;
+        size_t cnt;
+
+        /*
+         * Any change to the file that didn't come through here is reason
+         * enough to distrust everything on the screen.
+         */
+        vip = VIP(sp);
+        if (vip->rs == NULL)
+                return;
+        if (vip->rs_ep != sp->ep || (vip->rs_gen != sp->ep->c_gen &&
+            vip->rs_gen + 1 != sp->ep->c_gen)) {
+                VI_ROW_CFLUSH(vip);
+                return;
+        }
+        vip->rs_gen = sp->ep->c_gen;
+
+        /*
+         * Rows showing the changed line are damaged, rows showing later
+         * lines still show the same text under a new line number.  That
+         * isn't true if the number is displayed, or for line 1, which is
+         * displayed differently if the file is empty.
+         */
+        for (rp = vip->rs, cnt = vip->rs_len; cnt--; ++rp) {
+                if (rp->epoch != vip->rs_epoch ||
+                    rp->lno == OOBLNO || rp->lno < lno)
+                        continue;
+                switch (op) {
+                case LINE_DELETE:
+                        if (rp->lno == lno)
+                                rp->lno = OOBLNO;
+                        else
+                                --rp->lno;
+                        break;
+                case LINE_INSERT:
+                        ++rp->lno;
+                        break;
+                case LINE_RESET:
+                        if (rp->lno == lno)
+                                rp->lno = OOBLNO;
+                        continue;
+                default:
+                        abort();
+                }
+                if (O_ISSET(sp, O_NUMBER) || rp->lno == 1)
+                        rp->lno = OOBLNO;
+        }
+}
+
+/*
+ * vs_row_scroll --
+ *      Update the painted rows for a line inserted (scrolling the rows
+ *      below it down) or deleted (scrolling them up) at a screen row.
+ *
+ * PUBLIC: void vs_row_scroll(SCR *, size_t, int);
+ */
+void
+vs_row_scroll(SCR *sp, size_t row, int up)
+{
+        VI_PRIVATE *vip;
+        size_t end;
+
+        vip = VIP(sp);
+        if ((end = LASTLINE(sp)) > vip->rs_len)
+                end = vip->rs_len;
+        if (row >= end)
+                return;
+        if (up) {
+                memmove(vip->rs + row, vip->rs + row + 1,
+                    (end - row - 1) * sizeof(*vip->rs));
+                vip->rs[end - 1].lno = OOBLNO;
+        } else {
+                memmove(vip->rs + row + 1, vip->rs + row,
+                    (end - row - 1) * sizeof(*vip->rs));
+                vip->rs[row].lno = OOBLNO;
+        }
+}
+
+/*
+ * vs_row_painted --
+ *      Return if a screen row shows the part of the line in its SMAP entry.
+ */
+static int
+vs_row_painted(SCR *sp, SMAP *smp)
+{
+        VI_PRIVATE *vip;
+        struct _vs_row *rp;
+        size_t row;
+
+        vip = VIP(sp);
+        row = smp - HMAP;
+        if (IS_ONELINE(sp) || F_ISSET(sp, SC_TINPUT_INFO) ||
+            row >= sp->t_maxrows || vs_row_sync(sp, vip))
+                return (0);
+        rp = vip->rs + row;
+        return (rp->epoch == vip->rs_epoch && rp->lno == smp->lno &&
+            rp->coff == smp->coff && rp->soff == smp->soff);
+}
+
+/*
+ * vs_row_set --
+ *      Remember what vs_line() painted on a screen row.
+ */
+static void
+vs_row_set(SCR *sp, SMAP *smp)
+{
+        VI_PRIVATE *vip;
+        struct _vs_row *rp;
+        size_t row;
+
+        vip = VIP(sp);
+        row = smp - HMAP;
+        if (IS_ONELINE(sp) || F_ISSET(sp, SC_TINPUT_INFO) ||
+            row >= sp->t_maxrows || vs_row_sync(sp, vip)) {
+                VI_ROW_CLR(vip, row);
+                return;
+        }
+        rp = vip->rs + row;
+        rp->lno = smp->lno;
+        rp->coff = smp->coff;
+        rp->soff = smp->soff;
+        rp->epoch = vip->rs_epoch;
+}
+
+/*
+ * vs_row_sync --
+ *      Size the painted rows for the screen, and start a new epoch if the
+ *      screen width or the file changed without our knowing.
+ */
+static int
+vs_row_sync(SCR *sp, VI_PRIVATE *vip)
+{
+        struct _vs_row *rs;
+        size_t len;
+
+        if (vip->rs_len != (len = SIZE_HMAP(sp))) {
+                if ((rs = openbsd_reallocarray(vip->rs,
+                    len, sizeof(*rs))) == NULL)
+                        return (1);
+                memset(rs, 0, len * sizeof(*rs));
+                vip->rs = rs;
+                vip->rs_len = len;
+                VI_ROW_CFLUSH(vip);
+        }
+        if (vip->rs_cols != sp->cols ||
+            vip->rs_ep != sp->ep || vip->rs_gen != sp->ep->c_gen) {
+                vip->rs_cols = sp->cols;
+                vip->rs_ep = sp->ep;
+                vip->rs_gen = sp->ep->c_gen;
+                VI_ROW_CFLUSH(vip);
+        }
+        return (0);
+}
@@ -287,6 +287,7 @@ vs_msg(SCR *sp, mtype_t mtype, char *line, size_t len)
                 if (mtype == M_ERR)
                         (void)gp->scr_attr(sp, SA_INVERSE, 1);
                 (void)printf("%.*s", (int)len, line);
+                gp->scr_bytes += len;
                 if (mtype == M_ERR)
                         (void)gp->scr_attr(sp, SA_INVERSE, 0);
                 (void)fflush(stdout);
@@ -431,6 +432,7 @@ vs_output(SCR *sp, mtype_t mtype, const char *line, int llen)
                                             LASTLINE(sp) - 1, 0);
                                         (void)gp->scr_clrtoeol(sp);
                                         (void)vs_divider(sp);
+                                        VI_ROW_CFLUSH(vip);
                                         F_SET(vip, VIP_DIVIDER);
                                         ++vip->totalcount;
                                         ++vip->linecount;
@@ -583,15 +585,19 @@ vs_ex_resolve(SCR *sp, int *continuep)
         }
 
         /* If ex wrote on the screen, refresh the screen image. */
-        if (F_ISSET(sp, SC_SCR_EXWROTE))
+        if (F_ISSET(sp, SC_SCR_EXWROTE)) {
                 F_SET(vip, VIP_N_EX_PAINT);
+                VI_ROW_CFLUSH(vip);
+        }
 
         /*
          * If we're not the bottom of the split screen stack, the screen
          * image itself is wrong, so redraw everything.
          */
-        if (TAILQ_NEXT(sp, q))
+        if (TAILQ_NEXT(sp, q)) {
                 F_SET(sp, SC_SCR_REDRAW);
+                VI_ROW_CFLUSH(vip);
+        }
 
         /* If ex changed the underlying file, the map itself is wrong. */
         if (F_ISSET(vip, VIP_N_EX_REDRAW))
@@ -764,6 +770,7 @@ vs_scroll(SCR *sp, int *continuep, sw_t wtype)
                 (void)gp->scr_move(sp, vip->totalcount <
                     sp->rows ? LASTLINE(sp) - vip->totalcount : 0, 0);
                 (void)gp->scr_deleteln(sp);
+                VI_ROW_CFLUSH(vip);
 
                 /* If there are screens below us, push them back into place. */
                 if (TAILQ_NEXT(sp, q)) {
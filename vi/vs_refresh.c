@@ -47,6 +47,7 @@ vs_repaint(SCR *sp, EVENT *evp)
         for (; evp->e_flno <= evp->e_tlno; ++evp->e_flno) {
                 smp = HMAP + evp->e_flno - 1;
                 SMAP_FLUSH(smp);
+                VI_ROW_CLR(VIP(sp), smp - HMAP);
                 if (vs_line(sp, smp, NULL, NULL))
                         return (1);
         }
@@ -64,7 +65,7 @@ vs_refresh(SCR *sp, int forcepaint)
 {
         GS *gp;
         SCR *tsp;
-        int need_refresh;
+        int need_refresh, painted;
         unsigned int priv_paint, pub_paint;
 
         gp = sp->gp;
@@ -77,8 +78,10 @@ vs_refresh(SCR *sp, int forcepaint)
          */
         if (F_ISSET(sp, SC_SCR_REDRAW))
                 TAILQ_FOREACH(tsp, &gp->dq, q)
-                        if (tsp != sp)
+                        if (tsp != sp) {
                                 F_SET(tsp, SC_SCR_REDRAW | SC_STATUS);
+                                VI_ROW_CFLUSH(VIP(tsp));
+                        }
 
         /*
          * 2: Related or dirtied screens, or screens with messages.
@@ -110,8 +113,8 @@ vs_refresh(SCR *sp, int forcepaint)
          * Also, always do it last -- that way, SC_SCR_REDRAW can be set
          * in the current screen only, and the screen won't flash.
          */
-        if (vs_paint(sp, UPDATE_CURSOR | (!forcepaint &&
-            F_ISSET(sp, SC_SCR_VI) && KEYS_WAITING(sp) ? 0 : UPDATE_SCREEN)))
+        painted = forcepaint || !F_ISSET(sp, SC_SCR_VI) || !KEYS_WAITING(sp);
+        if (vs_paint(sp, UPDATE_CURSOR | (painted ? UPDATE_SCREEN : 0)))
                 return (1);
 
         /*
@@ -142,6 +145,10 @@ vs_refresh(SCR *sp, int forcepaint)
          * for everything else, i.e. messages.
          */
         F_SET(sp, SC_SCR_VI);
+
+        /* The keys typed have been painted. */
+        if (painted && gp->lat_nsec != 0)
+                v_lat_paint(sp);
         return (0);
 }
 
@@ -184,8 +191,9 @@ vs_paint(SCR *sp, unsigned int flags)
          * displayed if the leftright flag is set.
          */
         if (F_ISSET(sp, SC_SCR_REFORMAT)) {
-                /* Invalidate the line size cache. */
+                /* Invalidate the line size and column caches. */
                 VI_SCR_CFLUSH(vip);
+                VI_COL_CFLUSH(vip);
 
                 /* Toss vs_line() cached information. */
                 if (F_ISSET(sp, SC_SCR_TOP)) {
@@ -278,6 +286,7 @@ small_fill:                     (void)gp->scr_move(sp, LASTLINE(sp), 0);
                                     --sp->t_rows, --TMAP) {
                                         (void)gp->scr_move(sp, TMAP - HMAP, 0);
                                         (void)gp->scr_clrtoeol(sp);
+                                        VI_ROW_CLR(vip, TMAP - HMAP);
                                 }
                                 if (vs_sm_fill(sp, LNO, P_FILL))
                                         return (1);
@@ -665,7 +674,9 @@ shifted:                /* Fill in screen map with the new offset. */
          * Lost big, do what you have to do.  We flush the cache, since
          * SC_SCR_REDRAW gets set when the screen isn't worth fixing, and
          * it's simpler to repaint.  So, don't trust anything that we
-         * think we know about it.
+         * think we know about it.  The one exception is the record of
+         * what vs_line() painted on each row:  rows that still show the
+         * right part of the right line aren't touched.
          */
 paint:  for (smp = HMAP; smp <= TMAP; ++smp)
                 SMAP_FLUSH(smp);
@@ -683,6 +694,7 @@ paint:  for (smp = HMAP; smp <= TMAP; ++smp)
                 for (cnt = sp->t_rows; cnt <= sp->t_maxrows; ++cnt) {
                         (void)gp->scr_move(sp, cnt, 0);
                         (void)gp->scr_clrtoeol(sp);
+                        VI_ROW_CLR(vip, cnt);
                 }
 
         didpaint = 1;
@@ -783,7 +795,7 @@ vs_modeline(SCR *sp)
         GS *gp;
         size_t cols, curcol, curlen, endpoint, len, midpoint;
         const char *t = NULL;
-        int ellipsis;
+        int ellipsis, est;
         char *p, buf[30];
         recno_t last = 0;
 
@@ -868,8 +880,13 @@ vs_modeline(SCR *sp)
         cols = sp->cols - 1;
         if (O_ISSET(sp, O_RULER)) {
             vs_column(sp, &curcol);
-            if (!(db_last(sp, &last))) {
-                  if (last > 1) {
+            if (!(db_last_est(sp, &last, &est))) {
+                  if (est) {
+                    len = snprintf(buf, sizeof(buf), "%lu:%lu  ~%lu%%",
+                        (unsigned long)sp->lno, (unsigned long)curcol + 1,
+                        sp->lno >= last ? 99UL :
+                        (unsigned long)((((unsigned long)sp->lno) * 100L) / (unsigned long)last));
+                  } else if (last > 1) {
                     len = snprintf(buf, sizeof(buf), "%lu:%lu  %2lu%%",
                         (unsigned long)sp->lno, (unsigned long)curcol + 1,
                         (unsigned long)((((unsigned long)sp->lno) * 100L) / (unsigned long)last));
@@ -19,11 +19,16 @@
 #include <bitstring.h>
 #include <limits.h>
 #include <stdio.h>
+#include <bsd_stdlib.h>
 #include <bsd_string.h>
 
 #include "../common/common.h"
 #include "vi.h"
 
+#define MINIMUM(a, b)   (((a) < (b)) ? (a) : (b))
+
+static int vs_ckadd(VI_PRIVATE *, size_t, size_t);
+
 /*
  * vs_column --
  *      Return the logical column of the cursor in the line.
@@ -97,10 +102,14 @@ vs_screens(SCR *sp, recno_t lno, size_t *cnop)
 size_t
 vs_columns(SCR *sp, char *lp, recno_t lno, size_t *cnop, size_t *diffp)
 {
-        size_t chlen, cno, curoff, last, len, scno;
-        int ch, leftright, listset;
+        struct _vs_ckpt *ck;
+        VI_PRIVATE *vip;
+        size_t chlen, ckoff, curoff, end, glen, goff, last, len, off, scno;
+        int ch, fetched, leftright, listset, opts;
         char *p;
 
+        vip = VIP(sp);
+
         /*
          * Initialize the screen offset.
          */
@@ -113,9 +122,13 @@ vs_columns(SCR *sp, char *lp, recno_t lno, size_t *cnop, size_t *diffp)
                 curoff += O_NUMBER_LENGTH;
         }
 
-        /* Need the line to go any further. */
-        if (lp == NULL) {
-                (void)db_get(sp, lno, 0, &lp, &len);
+        /*
+         * Need the line to go any further.  If it's being input and is split
+         * by a gap after the cursor, step over the gap rather than closing it.
+         */
+        goff = glen = 0;
+        if ((fetched = lp == NULL)) {
+                (void)db_gget(sp, lno, 0, &lp, &len, &goff, &glen);
                 if (len == 0)
                         goto done;
         }
@@ -158,22 +171,53 @@ done:           if (diffp != NULL)              /* XXX */
                         curoff -= sp->cols;                             \
         }                                                               \
 }
-        if (cnop == NULL)
-                while (len--) {
-                        chlen = CHLEN(curoff);
-                        last = scno;
-                        scno += chlen;
-                        TAB_RESET;
+        /*
+         * Walk the line up to and including the character we care about, or
+         * to its end.  Long lines fetched here (the text input code measures
+         * lines it is still changing) start from the closest checkpoint, and
+         * fill in any checkpoints they pass.
+         */
+        off = 0;
+        end = cnop == NULL ? len : *cnop + 1;
+        ckoff = SIZE_MAX;
+        if (fetched && len >= VS_CKSTRIDE && end <= len &&
+            !F_ISSET(sp, SC_TINPUT)) {
+                opts = (listset ? 1 : 0) |
+                    (leftright ? 2 : 0) | (O_ISSET(sp, O_NUMBER) ? 4 : 0);
+                if (vip->ck_lno != lno || vip->ck_ep != sp->ep ||
+                    vip->ck_gen != sp->ep->c_gen ||
+                    vip->ck_cols != sp->cols ||
+                    vip->ck_ts != O_VAL(sp, O_TABSTOP) ||
+                    vip->ck_opts != opts) {
+                        vip->ck_lno = lno;
+                        vip->ck_ep = sp->ep;
+                        vip->ck_gen = sp->ep->c_gen;
+                        vip->ck_cols = sp->cols;
+                        vip->ck_ts = O_VAL(sp, O_TABSTOP);
+                        vip->ck_opts = opts;
+                        vip->ck_cnt = 0;
                 }
-        else
-                for (cno = *cnop;; --cno) {
-                        chlen = CHLEN(curoff);
-                        last = scno;
-                        scno += chlen;
-                        TAB_RESET;
-                        if (cno == 0)
-                                break;
+                if (vip->ck_cnt != 0) {
+                        ck = vip->ck + MINIMUM(vip->ck_cnt - 1,
+                            (end - 1) / VS_CKSTRIDE);
+                        off = (ck - vip->ck) * VS_CKSTRIDE;
+                        scno = ck->scno;
+                        curoff = ck->curoff;
+                        p = lp + off;
                 }
+                ckoff = vip->ck_cnt * VS_CKSTRIDE;
+        }
+        for (; off < end; ++off) {
+                if (off == ckoff)
+                        ckoff = vs_ckadd(vip, scno, curoff) ?
+                            SIZE_MAX : ckoff + VS_CKSTRIDE;
+                if (off == goff && glen != 0)
+                        p += glen;
+                chlen = CHLEN(curoff);
+                last = scno;
+                scno += chlen;
+                TAB_RESET;
+        }
 
         /* Add the trailing '$' if the O_LIST option set. */
         if (listset && cnop == NULL)
@@ -189,6 +233,28 @@ done:           if (diffp != NULL)              /* XXX */
         return (scno);
 }
 
+/*
+ * vs_ckadd --
+ *      Append a vs_columns() checkpoint.
+ */
+static int
+vs_ckadd(VI_PRIVATE *vip, size_t scno, size_t curoff)
+{
+        struct _vs_ckpt *ck;
+
+        if (vip->ck_cnt == vip->ck_len) {
+                if ((ck = openbsd_reallocarray(vip->ck,
+                    vip->ck_len + 64, sizeof(*ck))) == NULL)
+                        return (1);
+                vip->ck = ck;
+                vip->ck_len += 64;
+        }
+        ck = vip->ck + vip->ck_cnt++;
+        ck->scno = scno;
+        ck->curoff = curoff;
+        return (0);
+}
+
 /*
  * vs_rcm --
  *      Return the physical column from the line that will display a
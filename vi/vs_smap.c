@@ -74,6 +74,9 @@ vs_change(SCR *sp, recno_t lno, lnop_t op)
                 op = LINE_INSERT;
         }
 
+        /* Update what we know about the painted rows. */
+        vs_row_change(sp, lno, op);
+
         /* Ignore the change if the line is after the map. */
         if (lno > TMAP->lno)
                 return (0);
@@ -788,6 +791,7 @@ vs_deleteln(SCR *sp, int cnt)
                         (void)gp->scr_move(sp, LASTLINE(sp), 0);
                         (void)gp->scr_insertln(sp);
                         (void)gp->scr_move(sp, oldy, oldx);
+                        vs_row_scroll(sp, oldy, 1);
                 }
         }
         return (0);
@@ -959,6 +963,7 @@ vs_sm_erase(SCR *sp)
         for (; sp->t_rows > sp->t_minrows; --sp->t_rows, --TMAP) {
                 (void)gp->scr_move(sp, TMAP - HMAP, 0);
                 (void)gp->scr_clrtoeol(sp);
+                VI_ROW_CLR(VIP(sp), TMAP - HMAP);
         }
         return (0);
 }
@@ -1015,6 +1020,7 @@ vs_insertln(SCR *sp, int cnt)
                         (void)gp->scr_deleteln(sp);
                         (void)gp->scr_move(sp, oldy, oldx);
                         (void)gp->scr_insertln(sp);
+                        vs_row_scroll(sp, oldy, 0);
                 }
         }
         return (0);
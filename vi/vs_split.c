@@ -120,6 +120,9 @@ vs_split(SCR *sp, SCR *new, int ccl)
         sp->t_maxrows = IS_ONELINE(sp) ? 1 : sp->rows - 1;
         new->t_maxrows = IS_ONELINE(new) ? 1 : new->rows - 1;
 
+        /* The parent's rows may have moved. */
+        VI_ROW_CFLUSH(VIP(sp));
+
         /*
          * Small screens: see vs_refresh.c, section 6a.
          *
@@ -257,6 +260,7 @@ vs_discard(SCR *sp, SCR **spp)
         sp->defscroll = sp->t_maxrows / 2;
         *(HMAP + (sp->t_rows - 1)) = *TMAP;
         TMAP = HMAP + (sp->t_rows - 1);
+        VI_ROW_CFLUSH(VIP(sp));
 
         /*
          * Draw the new screen from scratch, and add a status line.
@@ -450,6 +454,7 @@ vs_swap(SCR *sp, SCR **nspp, char *name)
          * note that the cursor is wrong.
          */
         F_SET(VIP(nsp), VIP_CUR_INVALID);
+        VI_ROW_CFLUSH(VIP(nsp));
 
         /* Draw the new screen from scratch, and add a status line. */
         F_SET(nsp, SC_SCR_REDRAW | SC_STATUS);
@@ -541,6 +546,7 @@ toosmall:                       msgq(sp, M_BERR,
         g->t_maxrows += count;
         _TMAP(g) += count;
         F_SET(g, SC_SCR_REFORMAT | SC_STATUS);
+        VI_ROW_CFLUSH(VIP(g));
 
         s->t_rows -= count;
         s->t_maxrows -= count;
@@ -548,6 +554,7 @@ toosmall:                       msgq(sp, M_BERR,
                 s->t_minrows = s->t_maxrows;
         _TMAP(s) -= count;
         F_SET(s, SC_SCR_REFORMAT | SC_STATUS);
+        VI_ROW_CFLUSH(VIP(s));
 
         return (0);
 }